@@ -18,7 +18,8 @@
 
 #include "alltrackersmodel.h"
 
-#include <unordered_map>
+#include <algorithm>
+#include <functional>
 
 #ifndef TREMOTESF_SAILFISHOS
 #include <QApplication>
@@ -27,9 +28,6 @@
 
 #include "torrentsproxymodel.h"
 
-#include "libtremotesf/stdutils.h"
-#include "libtremotesf/torrent.h"
-#include "libtremotesf/tracker.h"
 #include "modelutils.h"
 #include "trpc.h"
 
@@ -41,7 +39,10 @@ namespace tremotesf
         enum Role
         {
             TrackerRole = Qt::UserRole,
-            TorrentsRole
+            TorrentsRole,
+            DownloadSpeedRole,
+            UploadSpeedRole,
+            SizeWhenDoneRole
         };
     }
 #endif
@@ -53,10 +54,6 @@ namespace tremotesf
     {
         setRpc(rpc);
         setTorrentsProxyModel(torrentsProxyModel);
-
-        if (mRpc && mTorrentsProxyModel) {
-            update();
-        }
     }
 
 #ifdef TREMOTESF_SAILFISHOS
@@ -66,9 +63,6 @@ namespace tremotesf
 
     void AllTrackersModel::componentComplete()
     {
-        if (mRpc && mTorrentsProxyModel) {
-            update();
-        }
     }
 #endif
 
@@ -83,12 +77,19 @@ namespace tremotesf
                 return mRpc->torrentsCount();
             }
         } else {
-            const TrackerItem& item = mTrackers[static_cast<size_t>(index.row() - 1)];
+            const libtremotesf::InternedString& tracker = mTrackers[static_cast<size_t>(index.row() - 1)];
+            const TorrentsGroups::Group* group = mRpc->trackersGroups().group(tracker);
             switch (role) {
             case TrackerRole:
-                return item.tracker;
+                return tracker.toString();
             case TorrentsRole:
-                return item.torrents;
+                return group->torrents;
+            case DownloadSpeedRole:
+                return group->downloadSpeed;
+            case UploadSpeedRole:
+                return group->uploadSpeed;
+            case SizeWhenDoneRole:
+                return group->sizeWhenDone;
             }
         }
 #else
@@ -100,15 +101,22 @@ namespace tremotesf
                 return qApp->translate("tremotesf", "All (%L1)", "All trackers, %L1 - torrents count").arg(mRpc->torrentsCount());
             }
         } else {
-            const TrackerItem& item = mTrackers[static_cast<size_t>(index.row() - 1)];
+            const libtremotesf::InternedString& tracker = mTrackers[static_cast<size_t>(index.row() - 1)];
+            const TorrentsGroups::Group* group = mRpc->trackersGroups().group(tracker);
             switch (role) {
             case Qt::DecorationRole:
                 return QIcon::fromTheme(QLatin1String("network-server"));
             case Qt::DisplayRole:
                 //: %1 is a string (directory name or tracker domain name), %L2 is number of torrents
-                return qApp->translate("tremotesf", "%1 (%L2)").arg(item.tracker).arg(item.torrents);
+                return qApp->translate("tremotesf", "%1 (%L2)").arg(tracker.toString()).arg(group->torrents);
             case TrackerRole:
-                return item.tracker;
+                return tracker.toString();
+            case DownloadSpeedRole:
+                return group->downloadSpeed;
+            case UploadSpeedRole:
+                return group->uploadSpeed;
+            case SizeWhenDoneRole:
+                return group->sizeWhenDone;
             }
         }
 #endif
@@ -120,6 +128,15 @@ namespace tremotesf
         return mTrackers.size() + 1;
     }
 
+    bool AllTrackersModel::removeRows(int row, int count, const QModelIndex& parent)
+    {
+        beginRemoveRows(parent, row, row + count - 1);
+        const auto first(mTrackers.begin() + (row - 1));
+        mTrackers.erase(first, first + count);
+        endRemoveRows();
+        return true;
+    }
+
     Rpc* AllTrackersModel::rpc() const
     {
         return mRpc;
@@ -129,6 +146,10 @@ namespace tremotesf
     {
         if (rpc && !mRpc) {
             mRpc = rpc;
+            beginResetModel();
+            mTrackers = mRpc->trackersGroups().groups();
+            resetRows();
+            endResetModel();
             QObject::connect(mRpc, &Rpc::torrentsUpdated, this, &AllTrackersModel::update);
         }
     }
@@ -149,77 +170,89 @@ namespace tremotesf
     QHash<int, QByteArray> AllTrackersModel::roleNames() const
     {
         return {{TrackerRole, "tracker"},
-                {TorrentsRole, "torrents"}};
+                {TorrentsRole, "torrents"},
+                {DownloadSpeedRole, "downloadSpeed"},
+                {UploadSpeedRole, "uploadSpeed"},
+                {SizeWhenDoneRole, "sizeWhenDone"}};
     }
 #endif
 
-    void AllTrackersModel::update()
+    void AllTrackersModel::update(const std::vector<int>& removed, const std::vector<int>&, const std::vector<quint64>&, int added)
     {
-        if (mRpc->torrents().empty()) {
-            if (!mTrackers.empty()) {
-                const QModelIndex firstIndex(index(0));
-                emit dataChanged(firstIndex, firstIndex);
-
-                beginRemoveRows(QModelIndex(), 1, static_cast<int>(mTrackers.size()));
-                mTrackers.clear();
-                endRemoveRows();
+        if (!removed.empty() || added > 0) {
+            const QModelIndex firstIndex(index(0));
+            emit dataChanged(firstIndex, firstIndex);
+        }
 
-                mTorrentsProxyModel->setTracker(QString());
-            }
+        const TorrentsGroups& groups = mRpc->trackersGroups();
+        const std::vector<libtremotesf::InternedString>& changedGroups = groups.changedGroups();
+        if (changedGroups.empty()) {
             return;
         }
 
-        std::unordered_map<QString, int> trackers;
-        for (const auto& torrent : mRpc->torrents()) {
-            for (const libtremotesf::Tracker& tracker : torrent->trackers()) {
-                const QString& site = tracker.site();
-                auto found = trackers.find(site);
-                if (found == trackers.end()) {
-                    trackers.emplace(site, 1);
-                } else {
-                    ++(found->second);
+        {
+            std::vector<int> removedRows;
+            for (const libtremotesf::InternedString& tracker : changedGroups) {
+                if (!groups.group(tracker)) {
+                    const auto found(mRows.find(tracker));
+                    if (found != mRows.end()) {
+                        removedRows.push_back(found->second);
+                    }
                 }
             }
+            if (!removedRows.empty()) {
+                std::sort(removedRows.begin(), removedRows.end(), std::greater<int>());
+                ModelBatchRemover modelRemover(this);
+                for (int row : removedRows) {
+                    modelRemover.remove(row);
+                }
+                modelRemover.remove();
+                resetRows();
+            }
         }
-        const auto trackersEnd(trackers.end());
 
-        {
-            VectorBatchRemover<TrackerItem> remover(mTrackers);
-            ModelBatchRemover modelRemover(this);
-            for (int i = static_cast<int>(mTrackers.size()) - 1; i >= 0; --i) {
-                const auto found(trackers.find(mTrackers[static_cast<size_t>(i)].tracker));
-                if (found == trackersEnd) {
-                    remover.remove(i);
-                    modelRemover.remove(i + 1);
+        std::vector<int> changedRows;
+        std::vector<libtremotesf::InternedString> addedGroups;
+        for (const libtremotesf::InternedString& tracker : changedGroups) {
+            if (groups.group(tracker)) {
+                const auto found(mRows.find(tracker));
+                if (found == mRows.end()) {
+                    addedGroups.push_back(tracker);
+                } else {
+                    changedRows.push_back(found->second);
                 }
             }
-            remover.doRemove();
-            modelRemover.remove();
         }
 
-        mTrackers.reserve(trackers.size());
-
-        ModelBatchChanger changer(this);
-        for (int i = 0, max = static_cast<int>(mTrackers.size()); i < max; ++i) {
-            TrackerItem& item = mTrackers[static_cast<size_t>(i)];
-            const auto found(trackers.find(item.tracker));
-            if (found != trackersEnd) {
-                item.torrents = found->second;
-                changer.changed(i + 1);
-                trackers.erase(found);
+        if (!changedRows.empty()) {
+            std::sort(changedRows.begin(), changedRows.end());
+            ModelBatchChanger changer(this);
+            for (int row : changedRows) {
+                changer.changed(row);
             }
+            changer.changed();
         }
-        changer.changed();
 
-        if (!trackers.empty()) {
+        if (!addedGroups.empty()) {
             const int firstRow = static_cast<int>(mTrackers.size() + 1);
-            beginInsertRows(QModelIndex(), firstRow, firstRow + static_cast<int>(trackers.size()) - 1);
-            for (const auto& i : trackers) {
-                const QString& tracker = i.first;
-                const int torrents = i.second;
-                mTrackers.push_back(TrackerItem{std::move(tracker), torrents});
+            beginInsertRows(QModelIndex(), firstRow, firstRow + static_cast<int>(addedGroups.size()) - 1);
+            for (const libtremotesf::InternedString& tracker : addedGroups) {
+                mTrackers.push_back(tracker);
+                mRows.emplace(tracker, static_cast<int>(mTrackers.size()));
             }
             endInsertRows();
         }
+
+        if (mRpc->torrents().empty() && mTorrentsProxyModel) {
+            mTorrentsProxyModel->setTracker(QString());
+        }
+    }
+
+    void AllTrackersModel::resetRows()
+    {
+        mRows.clear();
+        for (size_t i = 0, max = mTrackers.size(); i < max; ++i) {
+            mRows.emplace(mTrackers[i], static_cast<int>(i) + 1);
+        }
     }
 }
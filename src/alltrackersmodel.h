@@ -19,11 +19,14 @@
 #ifndef TREMOTESF_ALLTRACKERSMODEL_H
 #define TREMOTESF_ALLTRACKERSMODEL_H
 
+#include <unordered_map>
 #include <vector>
 
 #include <QAbstractListModel>
 #include <QStringList>
 
+#include "libtremotesf/internedstring.h"
+
 #ifdef TREMOTESF_SAILFISHOS
 #include <QQmlParserStatus>
 #endif
@@ -48,6 +51,9 @@ namespace tremotesf
     public:
 #ifndef TREMOTESF_SAILFISHOS
         static const int TrackerRole = Qt::UserRole;
+        static const int DownloadSpeedRole = Qt::UserRole + 1;
+        static const int UploadSpeedRole = Qt::UserRole + 2;
+        static const int SizeWhenDoneRole = Qt::UserRole + 3;
 #endif
         explicit AllTrackersModel(Rpc* rpc = nullptr,
                                   TorrentsProxyModel* torrentsProxyModel = nullptr,
@@ -60,6 +66,7 @@ namespace tremotesf
 
         QVariant data(const QModelIndex& index, int role) const override;
         int rowCount(const QModelIndex&) const override;
+        bool removeRows(int row, int count, const QModelIndex& parent = QModelIndex()) override;
 
         Rpc* rpc() const;
         void setRpc(Rpc* rpc);
@@ -72,17 +79,14 @@ namespace tremotesf
         QHash<int, QByteArray> roleNames() const override;
 #endif
     private:
-        struct TrackerItem
-        {
-            QString tracker;
-            int torrents;
-        };
-
-        void update();
+        void update(const std::vector<int>& removed, const std::vector<int>&, const std::vector<quint64>&, int added);
+        void resetRows();
 
         Rpc* mRpc;
         TorrentsProxyModel* mTorrentsProxyModel;
-        std::vector<TrackerItem> mTrackers;
+        std::vector<libtremotesf::InternedString> mTrackers;
+        // Model rows of trackers, rebuilt after rows are removed
+        std::unordered_map<libtremotesf::InternedString, int> mRows;
     };
 }
 
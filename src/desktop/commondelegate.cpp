@@ -19,16 +19,61 @@
 #include "commondelegate.h"
 
 #include <QApplication>
+#include <QPainter>
 #include <QProxyStyle>
 #include <QStyle>
 #include <QStyleOptionProgressBar>
 
 namespace tremotesf
 {
+    namespace
+    {
+        // Pixmaps for different column widths accumulate when columns are resized
+        const int maxProgressBarPixmaps = 1024;
+
+        const int progressBarStates = QStyle::State_Enabled |
+                                      QStyle::State_Horizontal |
+                                      QStyle::State_HasFocus |
+                                      QStyle::State_MouseOver |
+                                      QStyle::State_Selected |
+                                      QStyle::State_Active;
+
+        // width: 16 bits, height: 12 bits, progress: 7 bits, device pixel ratio * 64: 9 bits, state: 17 bits
+        quint64 progressBarKey(const QSize& size, int progress, qreal devicePixelRatio, QStyle::State state)
+        {
+            return (static_cast<quint64>(size.width() & 0xffff)) |
+                   (static_cast<quint64>(size.height() & 0xfff) << 16) |
+                   (static_cast<quint64>(progress & 0x7f) << 28) |
+                   (static_cast<quint64>(qRound(devicePixelRatio * 64) & 0x1ff) << 35) |
+                   (static_cast<quint64>(static_cast<int>(state) & progressBarStates) << 44);
+        }
+
+        // Styles that animate determinate progress bars, these are painted directly
+        bool isProgressBarAnimated(const QStyle* style)
+        {
+            return style->objectName() == QLatin1String("macintosh");
+        }
+
+        void drawProgressBar(const QStyleOptionProgressBar& progressBar, QPainter* painter)
+        {
+#ifdef Q_OS_WIN
+            // hack to remove progress bar animation
+            if (qApp->style()->objectName() == QLatin1String("windowsvista")) {
+                QProxyStyle(QLatin1String("windowsvista")).drawControl(QStyle::CE_ProgressBar, &progressBar, painter);
+                return;
+            }
+#endif
+            qApp->style()->drawControl(QStyle::CE_ProgressBar, &progressBar, painter);
+        }
+    }
+
     CommonDelegate::CommonDelegate(int progressBarColumn, int progressBarRole, QObject* parent)
         : QStyledItemDelegate(parent),
           mProgressBarColumn(progressBarColumn),
-          mProgressBarRole(progressBarRole)
+          mProgressBarRole(progressBarRole),
+          mProgressBarStyle(nullptr),
+          mProgressBarPaletteKey(0),
+          mProgressBarAnimated(false)
     {
     }
 
@@ -51,14 +96,38 @@ namespace tremotesf
             }
             progressBar.state = option.state;
 
-#ifdef Q_OS_WIN
-            // hack to remove progress bar animation
-            if (qApp->style()->objectName() == QLatin1String("windowsvista")) {
-                QProxyStyle(QLatin1String("windowsvista")).drawControl(QStyle::CE_ProgressBar, &progressBar, painter);
+            const QStyle* style = qApp->style();
+            if (style != mProgressBarStyle || progressBar.palette.cacheKey() != mProgressBarPaletteKey) {
+                mProgressBarPixmaps.clear();
+                mProgressBarStyle = style;
+                mProgressBarPaletteKey = progressBar.palette.cacheKey();
+                mProgressBarAnimated = isProgressBarAnimated(style);
+            }
+
+            if (mProgressBarAnimated) {
+                drawProgressBar(progressBar, painter);
                 return;
             }
-#endif
-            qApp->style()->drawControl(QStyle::CE_ProgressBar, &progressBar, painter);
+
+            // Progress is an integer percent, so there are at most 100 pixmaps for each size and state
+            const qreal devicePixelRatio = painter->device()->devicePixelRatioF();
+            const quint64 key = progressBarKey(rect.size(), progressBar.progress, devicePixelRatio, progressBar.state);
+            auto found(mProgressBarPixmaps.find(key));
+            if (found == mProgressBarPixmaps.end()) {
+                if (mProgressBarPixmaps.size() >= maxProgressBarPixmaps) {
+                    mProgressBarPixmaps.clear();
+                }
+                QPixmap pixmap(rect.size() * devicePixelRatio);
+                pixmap.setDevicePixelRatio(devicePixelRatio);
+                pixmap.fill(Qt::transparent);
+                QPainter pixmapPainter(&pixmap);
+                progressBar.rect = QRect(QPoint(), rect.size());
+                progressBar.state &= progressBarStates;
+                drawProgressBar(progressBar, &pixmapPainter);
+                pixmapPainter.end();
+                found = mProgressBarPixmaps.insert(key, pixmap);
+            }
+            painter->drawPixmap(rect.topLeft(), *found);
         }
     }
 
@@ -19,6 +19,8 @@
 #ifndef TREMOTESF_COMMONDELEGATE_H
 #define TREMOTESF_COMMONDELEGATE_H
 
+#include <QHash>
+#include <QPixmap>
 #include <QStyledItemDelegate>
 
 namespace tremotesf
@@ -33,6 +35,12 @@ namespace tremotesf
     private:
         int mProgressBarColumn;
         int mProgressBarRole;
+
+        // Rendered progress bars, cleared when style or palette is changed
+        mutable QHash<quint64, QPixmap> mProgressBarPixmaps;
+        mutable const QStyle* mProgressBarStyle;
+        mutable qint64 mProgressBarPaletteKey;
+        mutable bool mProgressBarAnimated;
     };
 }
 
@@ -40,6 +40,7 @@
 #include <QMessageBox>
 #include <QPushButton>
 #include <QScreen>
+#include <QShowEvent>
 #include <QSplitter>
 #include <QSystemTrayIcon>
 #include <QTimer>
@@ -59,6 +60,7 @@
 #include "../ipcclient.h"
 #include "../ipcserver.h"
 #include "../localtorrentfilesmodel.h"
+#include "../pathexistencecache.h"
 #include "../servers.h"
 #include "../settings.h"
 #include "../torrentfileparser.h"
@@ -76,6 +78,7 @@
 #include "serversettingsdialog.h"
 #include "serverstatsdialog.h"
 #include "settingsdialog.h"
+#include "throttledupdate.h"
 #include "torrentpropertiesdialog.h"
 #include "torrentsview.h"
 
@@ -161,6 +164,9 @@ namespace tremotesf
           mTorrentsView(new TorrentsView(mTorrentsProxyModel, this)),
           mTrayIcon(new QSystemTrayIcon(QIcon::fromTheme(QLatin1String("tremotesf-tray-icon"), windowIcon()), this))
     {
+        // Torrents list is not updated until window is shown
+        mTorrentsModel->setUpdatesSuspended(true);
+
         setWindowTitle(QLatin1String("Tremotesf"));
         setMinimumSize(minimumSizeHint().expandedTo(QSize(384, 256)));
 
@@ -353,6 +359,92 @@ namespace tremotesf
         }
     }
 
+    void MainWindow::showEvent(QShowEvent* event)
+    {
+        if (mTorrentsModel->isUpdatesSuspended()) {
+            mTorrentsModel->setUpdatesSuspended(false);
+            restoreTorrentsViewState();
+        }
+        QMainWindow::showEvent(event);
+    }
+
+    void MainWindow::hideEvent(QHideEvent* event)
+    {
+        QMainWindow::hideEvent(event);
+        // Minimized window is still visible
+        if (!isVisible() && !mTorrentsModel->isUpdatesSuspended()) {
+            saveTorrentsViewState();
+            mTorrentsModel->setUpdatesSuspended(true);
+        }
+    }
+
+    void MainWindow::saveTorrentsViewState()
+    {
+        const auto hash = [=](const QModelIndex& index) {
+            return mTorrentsModel->torrentAtIndex(mTorrentsProxyModel->sourceIndex(index))->hash();
+        };
+
+        const QItemSelectionModel* selectionModel = mTorrentsView->selectionModel();
+        for (const QModelIndex& index : selectionModel->selectedRows()) {
+            mSavedSelectedTorrents.insert(hash(index));
+        }
+
+        const QModelIndex current(selectionModel->currentIndex());
+        if (current.isValid()) {
+            mSavedCurrentTorrent = hash(current);
+        }
+
+        const QModelIndex top(mTorrentsView->indexAt(QPoint(0, 0)));
+        if (top.isValid()) {
+            mSavedTopTorrent = hash(top);
+        }
+    }
+
+    void MainWindow::restoreTorrentsViewState()
+    {
+        QItemSelection selection;
+        QModelIndex current;
+        QModelIndex top;
+        if (!mSavedSelectedTorrents.isEmpty() || !mSavedCurrentTorrent.isNull() || !mSavedTopTorrent.isNull()) {
+            for (int row = 0, max = mTorrentsModel->rowCount(QModelIndex()); row < max; ++row) {
+                const libtremotesf::TorrentHash& hash = mTorrentsModel->torrentAtRow(row)->hash();
+                const bool selected = mSavedSelectedTorrents.contains(hash);
+                if (hash.isNull() || (!selected && hash != mSavedCurrentTorrent && hash != mSavedTopTorrent)) {
+                    continue;
+                }
+                // Invalid if torrent is filtered out
+                const QModelIndex index(mTorrentsProxyModel->mapFromSource(mTorrentsModel->index(row, 0)));
+                if (!index.isValid()) {
+                    continue;
+                }
+                if (selected) {
+                    selection.select(index, index);
+                }
+                if (hash == mSavedCurrentTorrent) {
+                    current = index;
+                }
+                if (hash == mSavedTopTorrent) {
+                    top = index;
+                }
+            }
+        }
+
+        QItemSelectionModel* selectionModel = mTorrentsView->selectionModel();
+        if (current.isValid()) {
+            selectionModel->setCurrentIndex(current, QItemSelectionModel::NoUpdate);
+        }
+        if (!selection.isEmpty()) {
+            selectionModel->select(selection, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+        }
+        if (top.isValid()) {
+            mTorrentsView->scrollTo(top, QAbstractItemView::PositionAtTop);
+        }
+
+        mSavedSelectedTorrents.clear();
+        mSavedCurrentTorrent = libtremotesf::TorrentHash();
+        mSavedTopTorrent = libtremotesf::TorrentHash();
+    }
+
     void MainWindow::setupActions()
     {
         mConnectAction = new QAction(qApp->translate("tremotesf", "&Connect"), this);
@@ -422,13 +514,17 @@ namespace tremotesf
         QAction* setLocationAction = mTorrentMenu->addAction(qApp->translate("tremotesf", "Set &Location"));
         QObject::connect(setLocationAction, &QAction::triggered, this, [=]() {
             if (mTorrentsView->selectionModel()->hasSelection()) {
-                QModelIndexList indexes(mTorrentsProxyModel->sourceIndexes(mTorrentsView->selectionModel()->selectedRows()));
-                auto dialog = new SetLocationDialog(mTorrentsModel->torrentAtIndex(indexes.first())->downloadDirectory(),
+                const QModelIndex first(mTorrentsProxyModel->sourceIndex(mTorrentsView->selectionModel()->selectedRows().first()));
+                const std::vector<libtremotesf::TorrentHash> hashes(selectedTorrentsHashes());
+                auto dialog = new SetLocationDialog(mTorrentsModel->torrentAtIndex(first)->downloadDirectory(),
                                                     mRpc,
                                                     this);
                 dialog->setAttribute(Qt::WA_DeleteOnClose);
                 QObject::connect(dialog, &SetLocationDialog::accepted, this, [=]() {
-                    mRpc->setTorrentsLocation(mTorrentsModel->idsFromIndexes(indexes), dialog->downloadDirectory(), dialog->moveFiles());
+                    const QVariantList ids(idsFromHashes(hashes));
+                    if (!ids.isEmpty()) {
+                        mRpc->setTorrentsLocation(ids, dialog->downloadDirectory(), dialog->moveFiles());
+                    }
                 });
                 dialog->show();
             }
@@ -515,7 +611,12 @@ namespace tremotesf
         QObject::connect(Servers::instance(), &Servers::hasServersChanged, this, &MainWindow::updateRpcActions);
 
         updateTorrentActions();
-        QObject::connect(mRpc, &Rpc::torrentsUpdated, this, &MainWindow::updateTorrentActions);
+        const auto torrentActionsUpdate = new ThrottledUpdate(this, [=]() {
+            updateTorrentActions();
+        });
+        QObject::connect(mRpc, &Rpc::torrentsUpdated, torrentActionsUpdate, &ThrottledUpdate::request);
+        QObject::connect(mRpc->pathExistenceCache(), &PathExistenceCache::changed, torrentActionsUpdate, &ThrottledUpdate::request);
+        QObject::connect(mRpc, &Rpc::torrentsStaleChanged, this, &MainWindow::updateTorrentActions);
         QObject::connect(mTorrentsView->selectionModel(), &QItemSelectionModel::selectionChanged, this, &MainWindow::updateTorrentActions);
     }
 
@@ -621,7 +722,8 @@ namespace tremotesf
 
     void MainWindow::updateTorrentActions()
     {
-        if (mTorrentsView->selectionModel()->hasSelection()) {
+        // Ids of torrents from snapshot may belong to other torrents on server
+        if (mTorrentsView->selectionModel()->hasSelection() && !mRpc->isTorrentsStale()) {
             const QList<QAction*> actions(mTorrentMenu->actions());
             for (QAction* action : actions) {
                 action->setEnabled(true);
@@ -640,12 +742,13 @@ namespace tremotesf
             }
 
             if (mRpc->isLocal() || Servers::instance()->currentServerHasMountedDirectories()) {
+                PathExistenceCache* pathExistenceCache = mRpc->pathExistenceCache();
                 bool disableOpen = false;
                 bool disableBoth = false;
                 for (const QModelIndex& index : selectedRows) {
                     libtremotesf::Torrent* torrent = mTorrentsModel->torrentAtIndex(mTorrentsProxyModel->sourceIndex(index));
-                    if (mRpc->isTorrentLocalMounted(torrent) && QFile::exists(mRpc->localTorrentDownloadDirectoryPath(torrent))) {
-                        if (!disableOpen && !QFile::exists(mRpc->localTorrentFilesPath(torrent))) {
+                    if (mRpc->isTorrentLocalMounted(torrent) && pathExistenceCache->exists(mRpc->localTorrentDownloadDirectoryPath(torrent, true))) {
+                        if (!disableOpen && !pathExistenceCache->exists(mRpc->localTorrentFilesPath(torrent, true))) {
                             disableOpen = true;
                         }
                     } else {
@@ -674,6 +777,10 @@ namespace tremotesf
 
     void MainWindow::showTorrentsPropertiesDialogs()
     {
+        if (mRpc->isTorrentsStale()) {
+            return;
+        }
+
         const QModelIndexList selectedRows(mTorrentsView->selectionModel()->selectedRows());
 
         for (int i = 0, max = selectedRows.size(); i < max; i++) {
@@ -712,18 +819,48 @@ namespace tremotesf
         QCheckBox deleteFilesCheckBox(qApp->translate("tremotesf", "Also delete the files on the hard disk"));
         dialog.setCheckBox(&deleteFilesCheckBox);
 
-        const QVariantList ids(mTorrentsModel->idsFromIndexes(mTorrentsProxyModel->sourceIndexes(mTorrentsView->selectionModel()->selectedRows())));
-        if (ids.size() == 1) {
+        // Selected torrents may be removed or get new ids while dialog is shown
+        const std::vector<libtremotesf::TorrentHash> hashes(selectedTorrentsHashes());
+        if (hashes.size() == 1) {
             dialog.setWindowTitle(qApp->translate("tremotesf", "Remove Torrent"));
             dialog.setText(qApp->translate("tremotesf", "Are you sure you want to remove this torrent?"));
         } else {
             dialog.setWindowTitle(qApp->translate("tremotesf", "Remove Torrents"));
-            dialog.setText(qApp->translate("tremotesf", "Are you sure you want to remove %Ln selected torrents?", nullptr, ids.size()));
+            dialog.setText(qApp->translate("tremotesf", "Are you sure you want to remove %Ln selected torrents?", nullptr, static_cast<int>(hashes.size())));
         }
 
         if (dialog.exec() == QMessageBox::Ok) {
-            mRpc->removeTorrents(ids, deleteFilesCheckBox.checkState() == Qt::Checked);
+            const QVariantList ids(idsFromHashes(hashes));
+            if (!ids.isEmpty()) {
+                mRpc->removeTorrents(ids, deleteFilesCheckBox.checkState() == Qt::Checked);
+            }
+        }
+    }
+
+    std::vector<libtremotesf::TorrentHash> MainWindow::selectedTorrentsHashes() const
+    {
+        const QModelIndexList selectedRows(mTorrentsView->selectionModel()->selectedRows());
+        std::vector<libtremotesf::TorrentHash> hashes;
+        hashes.reserve(static_cast<size_t>(selectedRows.size()));
+        for (const QModelIndex& index : selectedRows) {
+            hashes.push_back(mTorrentsModel->torrentAtIndex(mTorrentsProxyModel->sourceIndex(index))->hash());
+        }
+        return hashes;
+    }
+
+    QVariantList MainWindow::idsFromHashes(const std::vector<libtremotesf::TorrentHash>& hashes) const
+    {
+        QVariantList ids;
+        if (mRpc->isTorrentsStale()) {
+            return ids;
+        }
+        ids.reserve(static_cast<int>(hashes.size()));
+        for (const libtremotesf::TorrentHash& hash : hashes) {
+            if (const libtremotesf::Torrent* torrent = mRpc->torrentByHash(hash)) {
+                ids.push_back(torrent->id());
+            }
         }
+        return ids;
     }
 
     void MainWindow::setupMenuBar()
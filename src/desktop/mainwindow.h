@@ -21,8 +21,13 @@
 
 #include <functional>
 #include <unordered_map>
+#include <vector>
 
 #include <QMainWindow>
+#include <QSet>
+#include <QVariant>
+
+#include "../libtremotesf/torrenthash.h"
 
 class QAction;
 class QMenu;
@@ -51,6 +56,8 @@ namespace tremotesf
 
     protected:
         void closeEvent(QCloseEvent* event) override;
+        void showEvent(QShowEvent* event) override;
+        void hideEvent(QHideEvent* event) override;
 
     private:
         void setupActions();
@@ -61,6 +68,9 @@ namespace tremotesf
         void showAddTorrentLinkDialogs(const QStringList& urls);
 
         void updateTorrentActions();
+        std::vector<libtremotesf::TorrentHash> selectedTorrentsHashes() const;
+        // Ids of torrents that still exist, empty while torrents are stale
+        QVariantList idsFromHashes(const std::vector<libtremotesf::TorrentHash>& hashes) const;
         void showTorrentsPropertiesDialogs();
         void removeSelectedTorrents();
 
@@ -70,6 +80,9 @@ namespace tremotesf
 
         void showWindow();
 
+        void saveTorrentsViewState();
+        void restoreTorrentsViewState();
+
         void runAfterDelay(const std::function<void()>& function);
 
         void showFinishedNotification(const QStringList& names);
@@ -116,6 +129,11 @@ namespace tremotesf
         QAction* mToolBarAction = nullptr;
 
         QSystemTrayIcon* mTrayIcon;
+
+        // Torrents view state saved while torrents list is suspended
+        QSet<libtremotesf::TorrentHash> mSavedSelectedTorrents;
+        libtremotesf::TorrentHash mSavedCurrentTorrent;
+        libtremotesf::TorrentHash mSavedTopTorrent;
     };
 }
 
@@ -34,6 +34,7 @@
 #include "../torrentsproxymodel.h"
 #include "../trpc.h"
 #include "../utils.h"
+#include "throttledupdate.h"
 
 namespace tremotesf
 {
@@ -56,16 +57,19 @@ namespace tremotesf
                 setIconSize(QSize(16, 16));
 
                 addItem(new QListWidgetItem(QApplication::style()->standardIcon(QStyle::SP_DirIcon), QString(), this));
-                addItem(new QListWidgetItem(QIcon(Utils::statusIconPath(Utils::ActiveIcon)), QString(), this));
-                addItem(new QListWidgetItem(QIcon(Utils::statusIconPath(Utils::DownloadingIcon)), QString(), this));
-                addItem(new QListWidgetItem(QIcon(Utils::statusIconPath(Utils::SeedingIcon)), QString(), this));
-                addItem(new QListWidgetItem(QIcon(Utils::statusIconPath(Utils::PausedIcon)), QString(), this));
-                addItem(new QListWidgetItem(QIcon(Utils::statusIconPath(Utils::CheckingIcon)), QString(), this));
-                addItem(new QListWidgetItem(QIcon(Utils::statusIconPath(Utils::ErroredIcon)), QString(), this));
+                addItem(new QListWidgetItem(Utils::statusIcon(Utils::ActiveIcon), QString(), this));
+                addItem(new QListWidgetItem(Utils::statusIcon(Utils::DownloadingIcon), QString(), this));
+                addItem(new QListWidgetItem(Utils::statusIcon(Utils::SeedingIcon), QString(), this));
+                addItem(new QListWidgetItem(Utils::statusIcon(Utils::PausedIcon), QString(), this));
+                addItem(new QListWidgetItem(Utils::statusIcon(Utils::CheckingIcon), QString(), this));
+                addItem(new QListWidgetItem(Utils::statusIcon(Utils::ErroredIcon), QString(), this));
                 setCurrentRow(0);
 
                 updateItems();
-                QObject::connect(mStats, &StatusFilterStats::updated, this, &StatusListWidget::updateItems);
+                const auto itemsUpdate = new ThrottledUpdate(this, [=]() {
+                    updateItems();
+                });
+                QObject::connect(mStats, &StatusFilterStats::updated, itemsUpdate, &ThrottledUpdate::request);
 
                 QObject::connect(this, &StatusListWidget::currentRowChanged, this, [this](int row) {
                     mProxyModel->setStatusFilter(static_cast<TorrentsProxyModel::StatusFilter>(row));
@@ -0,0 +1,66 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "throttledupdate.h"
+
+#include <QEvent>
+#include <QWidget>
+
+namespace tremotesf
+{
+    namespace
+    {
+        const int frameInterval = 16; // ms
+    }
+
+    ThrottledUpdate::ThrottledUpdate(QWidget* widget, const std::function<void()>& function)
+        : QObject(widget),
+          mWidget(widget),
+          mFunction(function),
+          mPending(false)
+    {
+        mTimer.setSingleShot(true);
+        mTimer.setInterval(frameInterval);
+        QObject::connect(&mTimer, &QTimer::timeout, this, &ThrottledUpdate::update);
+        mWidget->installEventFilter(this);
+    }
+
+    void ThrottledUpdate::request()
+    {
+        mPending = true;
+        if (mWidget->isVisible() && !mTimer.isActive()) {
+            mTimer.start();
+        }
+    }
+
+    bool ThrottledUpdate::eventFilter(QObject*, QEvent* event)
+    {
+        if (event->type() == QEvent::Show && mPending && !mTimer.isActive()) {
+            mTimer.start();
+        }
+        return false;
+    }
+
+    void ThrottledUpdate::update()
+    {
+        if (mPending && mWidget->isVisible()) {
+            mPending = false;
+            mFunction();
+        }
+    }
+}
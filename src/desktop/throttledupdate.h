@@ -0,0 +1,53 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TREMOTESF_THROTTLEDUPDATE_H
+#define TREMOTESF_THROTTLEDUPDATE_H
+
+#include <functional>
+
+#include <QObject>
+#include <QTimer>
+
+class QWidget;
+
+namespace tremotesf
+{
+    // Coalesces update requests: function is called once per display frame at most,
+    // and not at all while widget is hidden (it is called when widget is shown again)
+    class ThrottledUpdate : public QObject
+    {
+    public:
+        explicit ThrottledUpdate(QWidget* widget, const std::function<void()>& function);
+
+        void request();
+
+    protected:
+        bool eventFilter(QObject* watched, QEvent* event) override;
+
+    private:
+        void update();
+
+        QWidget* mWidget;
+        std::function<void()> mFunction;
+        QTimer mTimer;
+        bool mPending;
+    };
+}
+
+#endif // TREMOTESF_THROTTLEDUPDATE_H
@@ -110,7 +110,7 @@ namespace tremotesf
 
         dialogButtonBox->button(QDialogButtonBox::Close)->setDefault(true);
 
-        const QString torrentHash(mTorrent->hashString());
+        const libtremotesf::TorrentHash torrentHash(mTorrent->hash());
         QObject::connect(mRpc, &Rpc::torrentsUpdated, this, [=]() {
             setTorrent(mRpc->torrentByHash(torrentHash));
         });
@@ -0,0 +1,121 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "directorytrie.h"
+
+#include <algorithm>
+
+#include <QStringBuilder>
+
+namespace tremotesf
+{
+    namespace
+    {
+        // Calls function(component, end) for each '/' separated component of path until it returns false
+        template<typename Function>
+        void forEachComponent(const QString& path, const Function& function)
+        {
+            int start = 0;
+            while (true) {
+                int end = path.indexOf(QLatin1Char('/'), start);
+                if (end == -1) {
+                    end = path.size();
+                }
+                if (!function(path.midRef(start, end - start), end) || end == path.size()) {
+                    return;
+                }
+                start = end + 1;
+            }
+        }
+    }
+
+    void DirectoryTrie::clear()
+    {
+        mNodes.clear();
+        mMappedDirectories.clear();
+    }
+
+    void DirectoryTrie::add(const QString& directory, const QString& mappedDirectory)
+    {
+        if (mNodes.empty()) {
+            mNodes.emplace_back();
+        }
+
+        size_t node = 0;
+        forEachComponent(directory, [&](const QStringRef& component, int) {
+            const auto& children = mNodes[node].children;
+            const auto found(std::find_if(children.begin(), children.end(), [&](const std::pair<QString, size_t>& child) {
+                return child.first == component;
+            }));
+            if (found == children.end()) {
+                const size_t child = mNodes.size();
+                mNodes[node].children.emplace_back(component.toString(), child);
+                mNodes.emplace_back();
+                node = child;
+            } else {
+                node = found->second;
+            }
+            return true;
+        });
+
+        if (mNodes[node].directory == -1) {
+            mNodes[node].directory = static_cast<int>(mMappedDirectories.size());
+            mMappedDirectories.push_back(mappedDirectory);
+        }
+    }
+
+    bool DirectoryTrie::contains(const QString& path) const
+    {
+        return find(path).first != -1;
+    }
+
+    QString DirectoryTrie::map(const QString& path) const
+    {
+        const std::pair<int, int> found(find(path));
+        if (found.first == -1) {
+            return QString();
+        }
+        return mMappedDirectories[static_cast<size_t>(found.first)] % path.midRef(found.second);
+    }
+
+    std::pair<int, int> DirectoryTrie::find(const QString& path) const
+    {
+        std::pair<int, int> result(-1, 0);
+        if (mNodes.empty()) {
+            return result;
+        }
+
+        size_t node = 0;
+        forEachComponent(path, [&](const QStringRef& component, int end) {
+            const auto& children = mNodes[node].children;
+            const auto found(std::find_if(children.begin(), children.end(), [&](const std::pair<QString, size_t>& child) {
+                return child.first == component;
+            }));
+            if (found == children.end()) {
+                return false;
+            }
+            node = found->second;
+            const int directory = mNodes[node].directory;
+            if (directory != -1 && (result.first == -1 || directory < result.first)) {
+                result = {directory, end};
+            }
+            return true;
+        });
+        return result;
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TREMOTESF_DIRECTORYTRIE_H
+#define TREMOTESF_DIRECTORYTRIE_H
+
+#include <utility>
+#include <vector>
+
+#include <QString>
+
+namespace tremotesf
+{
+    // Maps paths under added directories to other directories, by comparing path components.
+    // When several added directories contain the path, the one that was added first is used
+    class DirectoryTrie
+    {
+    public:
+        void clear();
+        void add(const QString& directory, const QString& mappedDirectory);
+
+        bool contains(const QString& path) const;
+        // Returns empty string if path is not under any added directory
+        QString map(const QString& path) const;
+
+    private:
+        struct Node
+        {
+            std::vector<std::pair<QString, size_t>> children;
+            int directory = -1;
+        };
+
+        // Returns index of directory and length of matched part of path, or -1 and 0
+        std::pair<int, int> find(const QString& path) const;
+
+        std::vector<Node> mNodes;
+        std::vector<QString> mMappedDirectories;
+    };
+}
+
+#endif // TREMOTESF_DIRECTORYTRIE_H
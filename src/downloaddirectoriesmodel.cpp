@@ -18,14 +18,14 @@
 
 #include "downloaddirectoriesmodel.h"
 
-#include <unordered_map>
+#include <algorithm>
+#include <functional>
 
 #ifndef TREMOTESF_SAILFISHOS
 #include <QApplication>
 #include <QStyle>
 #endif
 
-#include "libtremotesf/stdutils.h"
 #include "libtremotesf/torrent.h"
 
 #include "modelutils.h"
@@ -40,7 +40,10 @@ namespace tremotesf
         enum Role
         {
             DirectoryRole = Qt::UserRole,
-            TorrentsRole
+            TorrentsRole,
+            DownloadSpeedRole,
+            UploadSpeedRole,
+            SizeWhenDoneRole
         };
     }
 #endif
@@ -48,14 +51,13 @@ namespace tremotesf
     DownloadDirectoriesModel::DownloadDirectoriesModel(Rpc* rpc, TorrentsProxyModel* torrentsProxyModel, QObject* parent)
         : QAbstractListModel(parent),
           mRpc(nullptr),
-          mTorrentsProxyModel(nullptr)
+          mTorrentsProxyModel(nullptr),
+          mGroups([](const libtremotesf::Torrent* torrent, std::vector<libtremotesf::InternedString>& groups) {
+              groups.push_back(torrent->data().downloadDirectory);
+          }, libtremotesf::TorrentData::DownloadDirectoryChanged)
     {
         setRpc(rpc);
         setTorrentsProxyModel(torrentsProxyModel);
-
-        if (mRpc && mTorrentsProxyModel) {
-            update();
-        }
     }
 
 #ifdef TREMOTESF_SAILFISHOS
@@ -65,9 +67,6 @@ namespace tremotesf
 
     void DownloadDirectoriesModel::componentComplete()
     {
-        if (mRpc && mTorrentsProxyModel) {
-            update();
-        }
     }
 #endif
 
@@ -82,12 +81,19 @@ namespace tremotesf
                 return mRpc->torrentsCount();
             }
         } else {
-            const DirectoryItem& item = mDirectories[static_cast<size_t>(index.row() - 1)];
+            const libtremotesf::InternedString& directory = mDirectories[static_cast<size_t>(index.row() - 1)];
+            const TorrentsGroups::Group* group = mGroups.group(directory);
             switch (role) {
             case DirectoryRole:
-                return item.directory;
+                return directory.toString();
             case TorrentsRole:
-                return item.torrents;
+                return group->torrents;
+            case DownloadSpeedRole:
+                return group->downloadSpeed;
+            case UploadSpeedRole:
+                return group->uploadSpeed;
+            case SizeWhenDoneRole:
+                return group->sizeWhenDone;
             }
         }
 #else
@@ -99,15 +105,22 @@ namespace tremotesf
                 return qApp->translate("tremotesf", "All (%L1)", "All trackers, %L1 - torrents count").arg(mRpc->torrentsCount());
             }
         } else {
-            const DirectoryItem& item = mDirectories[static_cast<size_t>(index.row() - 1)];
+            const libtremotesf::InternedString& directory = mDirectories[static_cast<size_t>(index.row() - 1)];
+            const TorrentsGroups::Group* group = mGroups.group(directory);
             switch (role) {
             case Qt::DecorationRole:
                 return QApplication::style()->standardIcon(QStyle::SP_DirIcon);
             case Qt::DisplayRole:
                 //: %1 is a string (directory name or tracker domain name), %L2 is number of torrents
-                return qApp->translate("tremotesf", "%1 (%L2)").arg(item.directory).arg(item.torrents);
+                return qApp->translate("tremotesf", "%1 (%L2)").arg(directory.toString()).arg(group->torrents);
             case DirectoryRole:
-                return item.directory;
+                return directory.toString();
+            case DownloadSpeedRole:
+                return group->downloadSpeed;
+            case UploadSpeedRole:
+                return group->uploadSpeed;
+            case SizeWhenDoneRole:
+                return group->sizeWhenDone;
             }
         }
 #endif
@@ -119,6 +132,15 @@ namespace tremotesf
         return mDirectories.size() + 1;
     }
 
+    bool DownloadDirectoriesModel::removeRows(int row, int count, const QModelIndex& parent)
+    {
+        beginRemoveRows(parent, row, row + count - 1);
+        const auto first(mDirectories.begin() + (row - 1));
+        mDirectories.erase(first, first + count);
+        endRemoveRows();
+        return true;
+    }
+
     Rpc* DownloadDirectoriesModel::rpc() const
     {
         return mRpc;
@@ -128,6 +150,7 @@ namespace tremotesf
     {
         if (rpc && !mRpc) {
             mRpc = rpc;
+            update({}, {}, {}, static_cast<int>(mRpc->torrents().size()));
             QObject::connect(mRpc, &Rpc::torrentsUpdated, this, &DownloadDirectoriesModel::update);
         }
     }
@@ -148,75 +171,88 @@ namespace tremotesf
     QHash<int, QByteArray> DownloadDirectoriesModel::roleNames() const
     {
         return {{DirectoryRole, "directory"},
-                {TorrentsRole, "torrents"}};
+                {TorrentsRole, "torrents"},
+                {DownloadSpeedRole, "downloadSpeed"},
+                {UploadSpeedRole, "uploadSpeed"},
+                {SizeWhenDoneRole, "sizeWhenDone"}};
     }
 #endif
 
-    void DownloadDirectoriesModel::update()
+    void DownloadDirectoriesModel::update(const std::vector<int>& removed, const std::vector<int>& changed, const std::vector<quint64>& changedFields, int added)
     {
-        if (mRpc->torrents().empty()) {
-            if (!mDirectories.empty()) {
-                const QModelIndex firstIndex(index(0));
-                emit dataChanged(firstIndex, firstIndex);
-
-                beginRemoveRows(QModelIndex(), 1, static_cast<int>(mDirectories.size()));
-                mDirectories.clear();
-                endRemoveRows();
+        if (!removed.empty() || added > 0) {
+            const QModelIndex firstIndex(index(0));
+            emit dataChanged(firstIndex, firstIndex);
+        }
 
-                mTorrentsProxyModel->setTracker(QString());
-            }
+        const std::vector<libtremotesf::InternedString>& changedGroups(mGroups.update(mRpc, removed, changed, changedFields, added));
+        if (changedGroups.empty()) {
             return;
         }
 
-        std::unordered_map<QString, int> directories;
-        for (const auto& torrent : mRpc->torrents()) {
-            const QString& directory = torrent->downloadDirectory();
-            auto found = directories.find(directory);
-            if (found == directories.end()) {
-                directories.emplace(directory, 1);
-            } else {
-                ++(found->second);
+        {
+            std::vector<int> removedRows;
+            for (const libtremotesf::InternedString& directory : changedGroups) {
+                if (!mGroups.group(directory)) {
+                    const auto found(mRows.find(directory));
+                    if (found != mRows.end()) {
+                        removedRows.push_back(found->second);
+                    }
+                }
+            }
+            if (!removedRows.empty()) {
+                std::sort(removedRows.begin(), removedRows.end(), std::greater<int>());
+                ModelBatchRemover modelRemover(this);
+                for (int row : removedRows) {
+                    modelRemover.remove(row);
+                }
+                modelRemover.remove();
+                resetRows();
             }
         }
-        const auto directoriesEnd(directories.end());
 
-        {
-            VectorBatchRemover<DirectoryItem> remover(mDirectories);
-            ModelBatchRemover modelRemover(this);
-            for (int i = static_cast<int>(mDirectories.size()) - 1; i >= 0; --i) {
-                const auto found(directories.find(mDirectories[static_cast<size_t>(i)].directory));
-                if (found == directoriesEnd) {
-                    remover.remove(i);
-                    modelRemover.remove(i + 1);
+        std::vector<int> changedRows;
+        std::vector<libtremotesf::InternedString> addedGroups;
+        for (const libtremotesf::InternedString& directory : changedGroups) {
+            if (mGroups.group(directory)) {
+                const auto found(mRows.find(directory));
+                if (found == mRows.end()) {
+                    addedGroups.push_back(directory);
+                } else {
+                    changedRows.push_back(found->second);
                 }
             }
-            remover.doRemove();
-            modelRemover.remove();
         }
 
-        mDirectories.reserve(directories.size());
-
-        ModelBatchChanger changer(this);
-        for (int i = 0, max = static_cast<int>(mDirectories.size()); i < max; ++i) {
-            DirectoryItem& item = mDirectories[static_cast<size_t>(i)];
-            const auto found(directories.find(item.directory));
-            if (found != directoriesEnd) {
-                item.torrents = found->second;
-                changer.changed(i + 1);
-                directories.erase(found);
+        if (!changedRows.empty()) {
+            std::sort(changedRows.begin(), changedRows.end());
+            ModelBatchChanger changer(this);
+            for (int row : changedRows) {
+                changer.changed(row);
             }
+            changer.changed();
         }
-        changer.changed();
 
-        if (!directories.empty()) {
+        if (!addedGroups.empty()) {
             const int firstRow = static_cast<int>(mDirectories.size() + 1);
-            beginInsertRows(QModelIndex(), firstRow, firstRow + static_cast<int>(directories.size()) - 1);
-            for (const auto& i : directories) {
-                const QString& tracker = i.first;
-                const int torrents = i.second;
-                mDirectories.push_back(DirectoryItem{std::move(tracker), torrents});
+            beginInsertRows(QModelIndex(), firstRow, firstRow + static_cast<int>(addedGroups.size()) - 1);
+            for (const libtremotesf::InternedString& directory : addedGroups) {
+                mDirectories.push_back(directory);
+                mRows.emplace(directory, static_cast<int>(mDirectories.size()));
             }
             endInsertRows();
         }
+
+        if (mRpc->torrents().empty() && mTorrentsProxyModel) {
+            mTorrentsProxyModel->setDownloadDirectory(QString());
+        }
+    }
+
+    void DownloadDirectoriesModel::resetRows()
+    {
+        mRows.clear();
+        for (size_t i = 0, max = mDirectories.size(); i < max; ++i) {
+            mRows.emplace(mDirectories[i], static_cast<int>(i) + 1);
+        }
     }
 }
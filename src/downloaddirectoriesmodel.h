@@ -19,11 +19,15 @@
 #ifndef TREMOTESF_DOWNLOADDIRECTORIESMODEL_H
 #define TREMOTESF_DOWNLOADDIRECTORIESMODEL_H
 
+#include <unordered_map>
 #include <vector>
 
 #include <QAbstractListModel>
 #include <QStringList>
 
+#include "libtremotesf/internedstring.h"
+#include "torrentsgroups.h"
+
 #ifdef TREMOTESF_SAILFISHOS
 #include <QQmlParserStatus>
 #endif
@@ -48,6 +52,9 @@ namespace tremotesf
     public:
 #ifndef TREMOTESF_SAILFISHOS
         static const int DirectoryRole = Qt::UserRole;
+        static const int DownloadSpeedRole = Qt::UserRole + 1;
+        static const int UploadSpeedRole = Qt::UserRole + 2;
+        static const int SizeWhenDoneRole = Qt::UserRole + 3;
 #endif
         explicit DownloadDirectoriesModel(Rpc* rpc = nullptr,
                                           TorrentsProxyModel* torrentsProxyModel = nullptr,
@@ -60,6 +67,7 @@ namespace tremotesf
 
         QVariant data(const QModelIndex& index, int role) const override;
         int rowCount(const QModelIndex&) const override;
+        bool removeRows(int row, int count, const QModelIndex& parent = QModelIndex()) override;
 
         Rpc* rpc() const;
         void setRpc(Rpc* rpc);
@@ -72,17 +80,15 @@ namespace tremotesf
         QHash<int, QByteArray> roleNames() const override;
 #endif
     private:
-        struct DirectoryItem
-        {
-            QString directory;
-            int torrents;
-        };
-
-        void update();
+        void update(const std::vector<int>& removed, const std::vector<int>& changed, const std::vector<quint64>& changedFields, int added);
+        void resetRows();
 
         Rpc* mRpc;
         TorrentsProxyModel* mTorrentsProxyModel;
-        std::vector<DirectoryItem> mDirectories;
+        TorrentsGroups mGroups;
+        std::vector<libtremotesf::InternedString> mDirectories;
+        // Model rows of directories, rebuilt after rows are removed
+        std::unordered_map<libtremotesf::InternedString, int> mRows;
     };
 }
 
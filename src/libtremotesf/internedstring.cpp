@@ -0,0 +1,160 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "internedstring.h"
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include <QDataStream>
+
+#include "stdutils.h"
+
+namespace libtremotesf
+{
+    namespace
+    {
+        struct StringTable
+        {
+            struct Entry
+            {
+                QString string;
+                int refs;
+            };
+
+            StringTable()
+            {
+                entries.push_back({QString(), 0});
+            }
+
+            // Deque doesn't invalidate references when appending
+            std::deque<Entry> entries;
+            std::unordered_map<QString, int> ids;
+            // Ids of removed entries
+            std::vector<int> freeIds;
+        };
+
+        StringTable& stringTable()
+        {
+            static StringTable table;
+            return table;
+        }
+    }
+
+    InternedString::InternedString(const QString& string)
+    {
+        if (string.isEmpty()) {
+            return;
+        }
+        StringTable& table = stringTable();
+        const auto found(table.ids.find(string));
+        if (found == table.ids.end()) {
+            if (table.freeIds.empty()) {
+                mId = static_cast<int>(table.entries.size());
+                table.entries.push_back({string, 1});
+            } else {
+                mId = table.freeIds.back();
+                table.freeIds.pop_back();
+                table.entries[static_cast<size_t>(mId)] = {string, 1};
+            }
+            table.ids.emplace(string, mId);
+        } else {
+            mId = found->second;
+            ref();
+        }
+    }
+
+    InternedString::InternedString(const InternedString& other)
+        : mId(other.mId)
+    {
+        ref();
+    }
+
+    InternedString::InternedString(InternedString&& other) noexcept
+        : mId(other.mId)
+    {
+        other.mId = 0;
+    }
+
+    InternedString::~InternedString()
+    {
+        deref();
+    }
+
+    InternedString& InternedString::operator=(const InternedString& other)
+    {
+        if (other.mId != mId) {
+            other.ref();
+            deref();
+            mId = other.mId;
+        }
+        return *this;
+    }
+
+    InternedString& InternedString::operator=(InternedString&& other) noexcept
+    {
+        if (&other != this) {
+            deref();
+            mId = other.mId;
+            other.mId = 0;
+        }
+        return *this;
+    }
+
+    const QString& InternedString::toString() const
+    {
+        return stringTable().entries[static_cast<size_t>(mId)].string;
+    }
+
+    void InternedString::ref() const
+    {
+        if (mId != 0) {
+            ++stringTable().entries[static_cast<size_t>(mId)].refs;
+        }
+    }
+
+    void InternedString::deref() const
+    {
+        if (mId == 0) {
+            return;
+        }
+        StringTable& table = stringTable();
+        StringTable::Entry& entry = table.entries[static_cast<size_t>(mId)];
+        --entry.refs;
+        if (entry.refs == 0) {
+            table.ids.erase(entry.string);
+            entry.string.clear();
+            table.freeIds.push_back(mId);
+        }
+    }
+
+    QDataStream& operator<<(QDataStream& stream, const InternedString& string)
+    {
+        return stream << string.toString();
+    }
+
+    QDataStream& operator>>(QDataStream& stream, InternedString& string)
+    {
+        QString value;
+        stream >> value;
+        string = InternedString(value);
+        return stream;
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTREMOTESF_INTERNEDSTRING_H
+#define LIBTREMOTESF_INTERNEDSTRING_H
+
+#include <functional>
+
+#include <QHashFunctions>
+#include <QString>
+
+class QDataStream;
+
+namespace libtremotesf
+{
+    // Immutable string stored only once in a global table and compared by its id.
+    // Used for low-cardinality strings that are repeated across many torrents
+    // (download directories, tracker sites, peer clients).
+    // Entries are reference counted and removed when last InternedString is destroyed,
+    // ids of removed entries are reused.
+    // Table is not synchronized: InternedStrings must be created, copied and destroyed
+    // only on GUI thread. Other threads may read existing strings only while GUI thread waits for them.
+    class InternedString
+    {
+    public:
+        InternedString() = default;
+        explicit InternedString(const QString& string);
+        InternedString(const InternedString& other);
+        InternedString(InternedString&& other) noexcept;
+        ~InternedString();
+
+        InternedString& operator=(const InternedString& other);
+        InternedString& operator=(InternedString&& other) noexcept;
+
+        int id() const { return mId; }
+        const QString& toString() const;
+        bool isEmpty() const { return mId == 0; }
+
+        inline bool operator==(const InternedString& other) const
+        {
+            return mId == other.mId;
+        }
+
+        inline bool operator!=(const InternedString& other) const
+        {
+            return mId != other.mId;
+        }
+
+    private:
+        void ref() const;
+        void deref() const;
+
+        // 0 is an empty string
+        int mId = 0;
+    };
+
+    inline uint qHash(const InternedString& string, uint seed = 0) noexcept
+    {
+        return ::qHash(string.id(), seed);
+    }
+
+    QDataStream& operator<<(QDataStream& stream, const InternedString& string);
+    QDataStream& operator>>(QDataStream& stream, InternedString& string);
+}
+
+namespace std
+{
+    template<>
+    struct hash<libtremotesf::InternedString>
+    {
+        size_t operator()(const libtremotesf::InternedString& string) const noexcept
+        {
+            return std::hash<int>{}(string.id());
+        }
+    };
+}
+
+#endif // LIBTREMOTESF_INTERNEDSTRING_H
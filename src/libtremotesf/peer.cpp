@@ -18,14 +18,38 @@
 
 #include "peer.h"
 
+#include <cstring>
+
+#include <QHostAddress>
 #include <QJsonObject>
 
 namespace libtremotesf
 {
+    namespace
+    {
+        // In the order used by Transmission
+        const char flagsCharacters[] = "TODdUuK?EHXI";
+        const int flagsCount = sizeof(flagsCharacters) - 1;
+    }
+
     const QJsonKeyString Peer::addressKey(QJsonKeyStringInit("address"));
 
-    Peer::Peer(QString&& address, const QJsonObject& peerJson)
-        : address(std::move(address)),
+    PeerKey PeerKey::fromJson(const QJsonObject& peerJson)
+    {
+        PeerKey key;
+        const Q_IPV6ADDR address(QHostAddress(peerJson.value(Peer::addressKey).toString()).toIPv6Address());
+        std::memcpy(key.address, address.c, sizeof(key.address));
+        key.port = static_cast<quint16>(peerJson.value(QJsonKeyStringInit("port")).toInt());
+        return key;
+    }
+
+    bool PeerKey::operator==(const PeerKey& other) const
+    {
+        return port == other.port && std::memcmp(address, other.address, sizeof(address)) == 0;
+    }
+
+    Peer::Peer(const PeerKey& key, const QJsonObject& peerJson)
+        : key(key),
           client(peerJson.value(QJsonKeyStringInit("clientName")).toString())
     {
         update(peerJson);
@@ -37,7 +61,43 @@ namespace libtremotesf
         setChanged(downloadSpeed, static_cast<long long>(peerJson.value(QJsonKeyStringInit("rateToClient")).toDouble()), changed);
         setChanged(uploadSpeed, static_cast<long long>(peerJson.value(QJsonKeyStringInit("rateToPeer")).toDouble()), changed);
         setChanged(progress, peerJson.value(QJsonKeyStringInit("progress")).toDouble(), changed);
-        setChanged(flags, peerJson.value(QJsonKeyStringInit("flagStr")).toString(), changed);
+        setChanged(flags, flagsFromString(peerJson.value(QJsonKeyStringInit("flagStr")).toString()), changed);
         return changed;
     }
+
+    QString Peer::address() const
+    {
+        const QHostAddress address(key.address);
+        bool ipv4 = false;
+        const quint32 ipv4Address = address.toIPv4Address(&ipv4);
+        if (ipv4) {
+            return QHostAddress(ipv4Address).toString();
+        }
+        return address.toString();
+    }
+
+    quint32 Peer::flagsFromString(const QString& flagStr)
+    {
+        quint32 flags = 0;
+        for (QChar ch : flagStr) {
+            for (int i = 0; i < flagsCount; ++i) {
+                if (ch == QLatin1Char(flagsCharacters[i])) {
+                    flags |= (1u << i);
+                    break;
+                }
+            }
+        }
+        return flags;
+    }
+
+    QString Peer::flagsString() const
+    {
+        QString flagStr;
+        for (int i = 0; i < flagsCount; ++i) {
+            if (flags & (1u << i)) {
+                flagStr.push_back(QLatin1Char(flagsCharacters[i]));
+            }
+        }
+        return flagStr;
+    }
 }
@@ -19,31 +19,70 @@
 #ifndef LIBTREMOTESF_PEER_H
 #define LIBTREMOTESF_PEER_H
 
+#include <functional>
+
+#include <QHashFunctions>
 #include <QString>
 
+#include "internedstring.h"
 #include "stdutils.h"
 
 class QJsonObject;
 
 namespace libtremotesf
 {
+    // Binary address and port of peer, used to match peers between updates
+    struct PeerKey
+    {
+        static PeerKey fromJson(const QJsonObject& peerJson);
+
+        bool operator==(const PeerKey& other) const;
+
+        // IPv4 addresses are stored as IPv4-mapped IPv6 addresses
+        quint8 address[16];
+        quint16 port;
+    };
+
+    inline uint qHash(const PeerKey& key, uint seed = 0) noexcept
+    {
+        return qHashBits(key.address, sizeof(key.address), ::qHash(key.port, seed));
+    }
+
     struct Peer
     {
         static const QJsonKeyString addressKey;
 
-        explicit Peer(QString&& address, const QJsonObject& peerJson);
+        explicit Peer(const PeerKey& key, const QJsonObject& peerJson);
         bool update(const QJsonObject& peerJson);
 
         bool operator==(const Peer& other) const {
-            return address == other.address;
+            return key == other.key;
         }
 
-        QString address;
-        QString client;
+        QString address() const;
+
+        // Bit for each character of Transmission's flagStr
+        static quint32 flagsFromString(const QString& flagStr);
+        QString flagsString() const;
+
+        PeerKey key;
+        InternedString client;
         long long downloadSpeed;
         long long uploadSpeed;
         double progress;
-        QString flags;
+        quint32 flags;
+    };
+}
+
+namespace std
+{
+    template<>
+    struct hash<libtremotesf::PeerKey>
+    {
+        size_t operator()(const libtremotesf::PeerKey& key) const noexcept
+        {
+            return libtremotesf::qHash(key);
+        }
     };
 }
 
@@ -20,8 +20,10 @@
 
 #include <QAuthenticator>
 #include <QCoreApplication>
+#include <QDataStream>
 #include <QDebug>
 #include <QFutureWatcher>
+#include <QHash>
 #include <QHostAddress>
 #include <QHostInfo>
 #include <QJsonArray>
@@ -56,6 +58,9 @@ namespace libtremotesf
         const auto torrentsKey(QJsonKeyStringInit("torrents"));
         const QLatin1String torrentDuplicateKey("torrent-duplicate");
 
+        const quint32 torrentsSnapshotMagic = 0x54534E50; // "TSNP"
+        const quint32 torrentsSnapshotVersion = 2;
+
         inline QByteArray makeRequestData(const QString& method, const QVariantMap& arguments)
         {
             return QJsonDocument::fromVariant(QVariantMap{{QStringLiteral("method"), method},
@@ -108,6 +113,7 @@ namespace libtremotesf
           mServerStatsUpdated(false),
           mUpdateTimer(new QTimer(this)),
           mServerSettings(createServerSettings ? new ServerSettings(this, this) : nullptr),
+          mTorrentsStale(false),
           mServerStats(new ServerStats(this)),
           mStatus(Disconnected),
           mError(NoError)
@@ -148,12 +154,83 @@ namespace libtremotesf
 
     Torrent* Rpc::torrentByHash(const QString& hash) const
     {
+        return torrentByHash(TorrentHash::fromHex(hash));
+    }
+
+    Torrent* Rpc::torrentByHash(const TorrentHash& hash) const
+    {
+        if (hash.isNull()) {
+            return nullptr;
+        }
+        return mTorrentsByHash.value(hash);
+    }
+
+    const TorrentsColumns& Rpc::torrentsColumns() const
+    {
+        return mTorrentsColumns;
+    }
+
+    QByteArray Rpc::saveTorrentsSnapshot() const
+    {
+        QByteArray snapshot;
+        QDataStream stream(&snapshot, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_6);
+        stream << torrentsSnapshotMagic << torrentsSnapshotVersion << static_cast<quint32>(mTorrents.size());
         for (const std::shared_ptr<Torrent>& torrent : mTorrents) {
-            if (torrent->hashString() == hash) {
-                return torrent.get();
+            stream << torrent->data();
+        }
+        return snapshot;
+    }
+
+    void Rpc::loadTorrentsSnapshot(const QByteArray& snapshot)
+    {
+        if (isConnected() || !mTorrents.empty() || snapshot.isEmpty()) {
+            return;
+        }
+
+        QDataStream stream(snapshot);
+        stream.setVersion(QDataStream::Qt_5_6);
+
+        quint32 magic;
+        quint32 version;
+        quint32 count;
+        stream >> magic >> version >> count;
+        if (stream.status() != QDataStream::Ok || magic != torrentsSnapshotMagic || version != torrentsSnapshotVersion) {
+            qWarning("Ignoring incompatible torrents snapshot");
+            return;
+        }
+
+        std::vector<std::shared_ptr<Torrent>> torrents;
+        torrents.reserve(count);
+        for (quint32 i = 0; i < count; ++i) {
+            TorrentData data;
+            stream >> data;
+            if (stream.status() != QDataStream::Ok) {
+                qWarning("Failed to read torrents snapshot");
+                return;
             }
+            torrents.push_back(std::make_shared<Torrent>(std::move(data), this));
+#ifdef TREMOTESF_SAILFISHOS
+            // prevent automatic destroying on QML side
+            QQmlEngine::setObjectOwnership(torrents.back().get(), QQmlEngine::CppOwnership);
+#endif
         }
-        return nullptr;
+
+        if (!torrents.empty()) {
+            mTorrents = std::move(torrents);
+            mTorrentsByHash.reserve(static_cast<int>(mTorrents.size()));
+            for (const std::shared_ptr<Torrent>& torrent : mTorrents) {
+                mTorrentsByHash.insert(torrent->hash(), torrent.get());
+                mTorrentsColumns.append(torrent->data());
+            }
+            emit torrentsUpdated({}, {}, {}, static_cast<int>(mTorrents.size()));
+            setTorrentsStale(true);
+        }
+    }
+
+    bool Rpc::isTorrentsStale() const
+    {
+        return mTorrentsStale;
     }
 
     bool Rpc::isConnected() const
@@ -698,6 +775,8 @@ namespace libtremotesf
             mServerStatsUpdated = false;
             mUpdateTimer->stop();
 
+            setTorrentsStale(false);
+
             emit statusChanged();
 
             if (wasConnected) {
@@ -711,7 +790,9 @@ namespace libtremotesf
                     removed.push_back(i);
                 }
                 mTorrents.clear();
-                emit torrentsUpdated(removed, {}, 0);
+                mTorrentsByHash.clear();
+                mTorrentsColumns.clear();
+                emit torrentsUpdated(removed, {}, {}, 0);
             }
 
             break;
@@ -731,6 +812,14 @@ namespace libtremotesf
         }
     }
 
+    void Rpc::setTorrentsStale(bool stale)
+    {
+        if (stale != mTorrentsStale) {
+            mTorrentsStale = stale;
+            emit torrentsStaleChanged();
+        }
+    }
+
     void Rpc::setError(Error error, const QString& errorMessage)
     {
         if (error != mError) {
@@ -834,25 +923,55 @@ namespace libtremotesf
                             removed.reserve(mTorrents.size() - newTorrents.size());
                         }
                         std::vector<int> changed;
+                        std::vector<quint64> changedFields;
                         {
+                            // Torrent ids are not persistent across daemon restarts,
+                            // so torrents from snapshot are matched by hash and adopt new ids
+                            QHash<TorrentHash, size_t> newTorrentsByHash;
+                            QHash<int, size_t> newTorrentsById;
+                            if (mTorrentsStale) {
+                                newTorrentsByHash.reserve(static_cast<int>(newTorrents.size()));
+                                const auto hashStringKey(QJsonKeyStringInit("hashString"));
+                                for (size_t i = 0, max = newTorrents.size(); i < max; ++i) {
+                                    newTorrentsByHash.insert(TorrentHash::fromHex(std::get<0>(newTorrents[i]).value(hashStringKey).toString()), i);
+                                }
+                            } else {
+                                newTorrentsById.reserve(static_cast<int>(newTorrents.size()));
+                                for (size_t i = 0, max = newTorrents.size(); i < max; ++i) {
+                                    newTorrentsById.insert(std::get<1>(newTorrents[i]), i);
+                                }
+                            }
+
                             const auto newTorrentsEnd(newTorrents.end());
                             VectorBatchRemover<std::shared_ptr<Torrent>> remover(mTorrents, &removed, &changed);
                             for (int i = static_cast<int>(mTorrents.size()) - 1; i >= 0; --i) {
                                 const auto& torrent = mTorrents[static_cast<size_t>(i)];
-                                const int id = torrent->id();
-                                const auto found(std::find_if(newTorrents.begin(), newTorrents.end(), [id](const auto& t) {
-                                    return std::get<1>(t) == id;
-                                }));
+                                auto found(newTorrentsEnd);
+                                if (mTorrentsStale) {
+                                    const auto index(newTorrentsByHash.constFind(torrent->hash()));
+                                    if (index != newTorrentsByHash.cend() && !std::get<2>(newTorrents[*index])) {
+                                        found = newTorrents.begin() + static_cast<std::ptrdiff_t>(*index);
+                                        torrent->setId(std::get<1>(*found));
+                                    }
+                                } else {
+                                    const auto index(newTorrentsById.constFind(torrent->id()));
+                                    if (index != newTorrentsById.cend()) {
+                                        found = newTorrents.begin() + static_cast<std::ptrdiff_t>(*index);
+                                    }
+                                }
                                 if (found == newTorrentsEnd) {
+                                    mTorrentsByHash.remove(torrent->hash());
                                     remover.remove(i);
                                 } else {
                                     std::get<2>(*found) = true;
+                                    const int id = torrent->id();
 
                                     const bool wasFinished = torrent->isFinished();
                                     torrent->update(std::get<0>(*found));
                                     if (torrent->isChanged()) {
                                         changed.push_back(i);
-                                        if (!wasFinished && torrent->isFinished()) {
+                                        changedFields.push_back(torrent->changedFields());
+                                        if (!wasFinished && torrent->isFinished() && isConnected()) {
                                             emit torrentFinished(torrent.get());
                                         }
                                     }
@@ -867,6 +986,7 @@ namespace libtremotesf
                             remover.doRemove();
                         }
                         std::reverse(changed.begin(), changed.end());
+                        std::reverse(changedFields.begin(), changedFields.end());
 
                         int added = 0;
                         if (newTorrents.size() > mTorrents.size()) {
@@ -879,6 +999,7 @@ namespace libtremotesf
                                     mTorrents.emplace_back(std::make_shared<Torrent>(id, torrentJson, this));
                                     ++added;
                                     Torrent* torrent = mTorrents.back().get();
+                                    mTorrentsByHash.insert(torrent->hash(), torrent);
 #ifdef TREMOTESF_SAILFISHOS
                                     // prevent automatic destroying on QML side
                                     QQmlEngine::setObjectOwnership(torrent, QQmlEngine::CppOwnership);
@@ -890,7 +1011,18 @@ namespace libtremotesf
                             }
                         }
 
-                        emit torrentsUpdated(removed, changed, added);
+                        mTorrentsColumns.remove(removed);
+                        for (size_t i = 0, max = changed.size(); i < max; ++i) {
+                            const auto index = static_cast<size_t>(changed[i]);
+                            mTorrentsColumns.set(index, mTorrents[index]->data(), changedFields[i]);
+                        }
+                        for (size_t i = mTorrentsColumns.size(), max = mTorrents.size(); i < max; ++i) {
+                            mTorrentsColumns.append(mTorrents[i]->data());
+                        }
+
+                        setTorrentsStale(false);
+
+                        emit torrentsUpdated(removed, changed, changedFields, added);
 
                         checkIfTorrentsUpdated();
                         startUpdateTimer();
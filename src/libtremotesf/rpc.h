@@ -25,11 +25,15 @@
 #include <unordered_set>
 
 #include <QByteArray>
+#include <QHash>
 #include <QObject>
 #include <QSslConfiguration>
 #include <QUrl>
 #include <QVariantList>
 
+#include "torrentscolumns.h"
+#include "torrenthash.h"
+
 class QAuthenticator;
 class QNetworkAccessManager;
 class QNetworkReply;
@@ -89,6 +93,7 @@ namespace libtremotesf
         Q_PROPERTY(Error error READ error NOTIFY errorChanged)
         Q_PROPERTY(bool local READ isLocal NOTIFY connectedChanged)
         Q_PROPERTY(int torrentsCount READ torrentsCount NOTIFY torrentsUpdated)
+        Q_PROPERTY(bool torrentsStale READ isTorrentsStale NOTIFY torrentsStaleChanged)
         Q_PROPERTY(bool backgroundUpdate READ backgroundUpdate WRITE setBackgroundUpdate NOTIFY backgroundUpdateChanged)
         Q_PROPERTY(bool updateDisabled READ isUpdateDisabled WRITE setUpdateDisabled NOTIFY updateDisabledChanged)
     public:
@@ -120,7 +125,14 @@ namespace libtremotesf
 
         const std::vector<std::shared_ptr<Torrent>>& torrents() const;
         Q_INVOKABLE libtremotesf::Torrent* torrentByHash(const QString& hash) const;
+        Torrent* torrentByHash(const TorrentHash& hash) const;
         std::shared_ptr<Torrent> torrentById(int id) const;
+        const TorrentsColumns& torrentsColumns() const;
+
+        QByteArray saveTorrentsSnapshot() const;
+        void loadTorrentsSnapshot(const QByteArray& snapshot);
+        // True while torrents are loaded from snapshot, their ids may belong to other torrents on server
+        bool isTorrentsStale() const;
 
         bool isConnected() const;
         Status status() const;
@@ -186,6 +198,7 @@ namespace libtremotesf
 
     private:
         void setStatus(Status status);
+        void setTorrentsStale(bool stale);
         void setError(Error error, const QString& errorMessage = QString());
 
         void getServerSettings();
@@ -236,6 +249,9 @@ namespace libtremotesf
 
         ServerSettings* mServerSettings;
         std::vector<std::shared_ptr<Torrent>> mTorrents;
+        QHash<TorrentHash, Torrent*> mTorrentsByHash;
+        TorrentsColumns mTorrentsColumns;
+        bool mTorrentsStale;
         ServerStats* mServerStats;
 
         Status mStatus;
@@ -248,7 +264,8 @@ namespace libtremotesf
         void statusChanged();
         void errorChanged();
 
-        void torrentsUpdated(const std::vector<int>& removed, const std::vector<int>& changed, int added);
+        // changedFields contains TorrentData::ChangedField flags for each index in changed
+        void torrentsUpdated(const std::vector<int>& removed, const std::vector<int>& changed, const std::vector<quint64>& changedFields, int added);
 
         void torrentFilesUpdated(const libtremotesf::Torrent* torrent, const std::vector<int>& changed);
         void torrentPeersUpdated(const libtremotesf::Torrent* torrent,
@@ -267,6 +284,7 @@ namespace libtremotesf
         void gotDownloadDirFreeSpace(long long bytes);
         void gotFreeSpaceForPath(const QString& path, bool success, long long bytes);
 
+        void torrentsStaleChanged();
         void backgroundUpdateChanged();
         void updateDisabledChanged();
     };
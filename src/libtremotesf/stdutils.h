@@ -124,6 +124,16 @@ namespace libtremotesf
         }
     }
 
+    template<typename T, typename V, typename Flags>
+    inline void setChanged(T& value, V&& newValue, Flags& changedFlags, typename std::decay<Flags>::type flag)
+    {
+        bool changed = false;
+        setChanged(value, static_cast<T>(std::forward<V>(newValue)), changed);
+        if (changed) {
+            changedFlags |= flag;
+        }
+    }
+
     template<typename T>
     class VectorBatchRemover
     {
@@ -19,8 +19,10 @@
 #include "torrent.h"
 
 #include <type_traits>
+#include <unordered_map>
 
 #include <QCoreApplication>
+#include <QDataStream>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QLocale>
@@ -93,37 +95,173 @@ namespace libtremotesf
         const QLatin1String addTrackerKey("trackerAdd");
         const QLatin1String replaceTrackerKey("trackerReplace");
         const QLatin1String removeTrackerKey("trackerRemove");
+
+        void updateDate(long long& date, const QJsonValue& value, quint64& changedFields, quint64 flag)
+        {
+            const long long newDate = static_cast<long long>(value.toDouble()) * 1000;
+            setChanged(date, newDate > 0 ? newDate : -1, changedFields, flag);
+        }
+
+        QDateTime dateTimeFromMSecs(long long msecs)
+        {
+            if (msecs < 0) {
+                return QDateTime();
+            }
+            return QDateTime::fromMSecsSinceEpoch(msecs);
+        }
+
+        void readDate(QDataStream& stream, long long& date)
+        {
+            qint64 msecs;
+            stream >> msecs;
+            date = msecs;
+        }
+
+        template<typename T>
+        void readEnum(QDataStream& stream, T& value)
+        {
+            qint32 i;
+            stream >> i;
+            value = static_cast<T>(i);
+        }
     }
 
     const QJsonKeyString Torrent::idKey(QJsonKeyStringInit("id"));
 
+    QDataStream& operator<<(QDataStream& stream, const TorrentData& data)
+    {
+        stream << data.id
+               << data.hash
+               << data.name
+               << data.errorString
+               << static_cast<qint32>(data.status)
+               << data.queuePosition
+               << data.totalSize
+               << data.completedSize
+               << data.leftUntilDone
+               << data.sizeWhenDone
+               << data.percentDone
+               << data.recheckProgress
+               << data.eta
+               << data.downloadSpeed
+               << data.uploadSpeed
+               << data.downloadSpeedLimited
+               << data.downloadSpeedLimit
+               << data.uploadSpeedLimited
+               << data.uploadSpeedLimit
+               << data.totalDownloaded
+               << data.totalUploaded
+               << data.ratio
+               << data.ratioLimit
+               << static_cast<qint32>(data.ratioLimitMode)
+               << data.seeders
+               << data.leechers
+               << data.peersLimit
+               << static_cast<qint64>(data.addedDate)
+               << static_cast<qint64>(data.activityDate)
+               << static_cast<qint64>(data.doneDate)
+               << static_cast<qint32>(data.idleSeedingLimitMode)
+               << data.idleSeedingLimit
+               << data.downloadDirectory
+               << data.comment
+               << data.creator
+               << static_cast<qint64>(data.creationDate)
+               << static_cast<qint32>(data.bandwidthPriority)
+               << data.honorSessionLimits
+               << data.singleFile;
+
+        stream << static_cast<quint32>(data.trackers.size());
+        for (const Tracker& tracker : data.trackers) {
+            stream << tracker;
+        }
+
+        return stream;
+    }
+
+    QDataStream& operator>>(QDataStream& stream, TorrentData& data)
+    {
+        stream >> data.id
+               >> data.hash
+               >> data.name
+               >> data.errorString;
+        readEnum(stream, data.status);
+        stream >> data.queuePosition
+               >> data.totalSize
+               >> data.completedSize
+               >> data.leftUntilDone
+               >> data.sizeWhenDone
+               >> data.percentDone
+               >> data.recheckProgress
+               >> data.eta
+               >> data.downloadSpeed
+               >> data.uploadSpeed
+               >> data.downloadSpeedLimited
+               >> data.downloadSpeedLimit
+               >> data.uploadSpeedLimited
+               >> data.uploadSpeedLimit
+               >> data.totalDownloaded
+               >> data.totalUploaded
+               >> data.ratio
+               >> data.ratioLimit;
+        readEnum(stream, data.ratioLimitMode);
+        stream >> data.seeders
+               >> data.leechers
+               >> data.peersLimit;
+        readDate(stream, data.addedDate);
+        readDate(stream, data.activityDate);
+        readDate(stream, data.doneDate);
+        readEnum(stream, data.idleSeedingLimitMode);
+        stream >> data.idleSeedingLimit
+               >> data.downloadDirectory
+               >> data.comment
+               >> data.creator;
+        readDate(stream, data.creationDate);
+        readEnum(stream, data.bandwidthPriority);
+        stream >> data.honorSessionLimits
+               >> data.singleFile;
+
+        quint32 trackersCount;
+        stream >> trackersCount;
+        data.trackers.clear();
+        for (quint32 i = 0; i < trackersCount && stream.status() == QDataStream::Ok; ++i) {
+            Tracker tracker;
+            stream >> tracker;
+            data.trackers.push_back(std::move(tracker));
+        }
+
+        data.trackersAddedOrRemoved = true;
+        data.changedFields = TorrentData::AllChanged;
+
+        return stream;
+    }
+
     void TorrentData::update(const QJsonObject& torrentMap, const Rpc* rpc)
     {
-        changed = false;
+        changedFields = 0;
 
-        setChanged(name, torrentMap.value(nameKey).toString(), changed);
+        setChanged(name, torrentMap.value(nameKey).toString(), changedFields, NameChanged);
 
-        setChanged(errorString, torrentMap.value(errorStringKey).toString(), changed);
-        setChanged(queuePosition, torrentMap.value(queuePositionKey).toInt(), changed);
-        setChanged(totalSize, static_cast<long long>(torrentMap.value(totalSizeKey).toDouble()), changed);
-        setChanged(completedSize, static_cast<long long>(torrentMap.value(completedSizeKey).toDouble()), changed);
-        setChanged(leftUntilDone, static_cast<long long>(torrentMap.value(leftUntilDoneKey).toDouble()), changed);
-        setChanged(sizeWhenDone, static_cast<long long>(torrentMap.value(sizeWhenDoneKey).toDouble()), changed);
-        setChanged(percentDone, torrentMap.value(percentDoneKey).toDouble(), changed);
-        setChanged(recheckProgress, torrentMap.value(recheckProgressKey).toDouble(), changed);
-        setChanged(eta, torrentMap.value(etaKey).toInt(), changed);
+        setChanged(errorString, torrentMap.value(errorStringKey).toString(), changedFields, ErrorStringChanged);
+        setChanged(queuePosition, torrentMap.value(queuePositionKey).toInt(), changedFields, QueuePositionChanged);
+        setChanged(totalSize, static_cast<long long>(torrentMap.value(totalSizeKey).toDouble()), changedFields, TotalSizeChanged);
+        setChanged(completedSize, static_cast<long long>(torrentMap.value(completedSizeKey).toDouble()), changedFields, CompletedSizeChanged);
+        setChanged(leftUntilDone, static_cast<long long>(torrentMap.value(leftUntilDoneKey).toDouble()), changedFields, LeftUntilDoneChanged);
+        setChanged(sizeWhenDone, static_cast<long long>(torrentMap.value(sizeWhenDoneKey).toDouble()), changedFields, SizeWhenDoneChanged);
+        setChanged(percentDone, torrentMap.value(percentDoneKey).toDouble(), changedFields, PercentDoneChanged);
+        setChanged(recheckProgress, torrentMap.value(recheckProgressKey).toDouble(), changedFields, RecheckProgressChanged);
+        setChanged(eta, torrentMap.value(etaKey).toInt(), changedFields, EtaChanged);
 
-        setChanged(downloadSpeed, static_cast<long long>(torrentMap.value(downloadSpeedKey).toDouble()), changed);
-        setChanged(uploadSpeed, static_cast<long long>(torrentMap.value(uploadSpeedKey).toDouble()), changed);
+        setChanged(downloadSpeed, static_cast<long long>(torrentMap.value(downloadSpeedKey).toDouble()), changedFields, DownloadSpeedChanged);
+        setChanged(uploadSpeed, static_cast<long long>(torrentMap.value(uploadSpeedKey).toDouble()), changedFields, UploadSpeedChanged);
 
-        setChanged(downloadSpeedLimited, torrentMap.value(downloadSpeedLimitedKey).toBool(), changed);
-        setChanged(downloadSpeedLimit, rpc->serverSettings()->toKibiBytes(torrentMap.value(downloadSpeedLimitKey).toInt()), changed);
-        setChanged(uploadSpeedLimited, torrentMap.value(uploadSpeedLimitedKey).toBool(), changed);
-        setChanged(uploadSpeedLimit, rpc->serverSettings()->toKibiBytes(torrentMap.value(uploadSpeedLimitKey).toInt()), changed);
+        setChanged(downloadSpeedLimited, torrentMap.value(downloadSpeedLimitedKey).toBool(), changedFields, DownloadSpeedLimitedChanged);
+        setChanged(downloadSpeedLimit, rpc->serverSettings()->toKibiBytes(torrentMap.value(downloadSpeedLimitKey).toInt()), changedFields, DownloadSpeedLimitChanged);
+        setChanged(uploadSpeedLimited, torrentMap.value(uploadSpeedLimitedKey).toBool(), changedFields, UploadSpeedLimitedChanged);
+        setChanged(uploadSpeedLimit, rpc->serverSettings()->toKibiBytes(torrentMap.value(uploadSpeedLimitKey).toInt()), changedFields, UploadSpeedLimitChanged);
 
-        setChanged(totalDownloaded, static_cast<long long>(torrentMap.value(totalDownloadedKey).toDouble()), changed);
-        setChanged(totalUploaded, static_cast<long long>(torrentMap.value(totalUploadedKey).toDouble()), changed);
-        setChanged(ratio, torrentMap.value(ratioKey).toDouble(), changed);
+        setChanged(totalDownloaded, static_cast<long long>(torrentMap.value(totalDownloadedKey).toDouble()), changedFields, TotalDownloadedChanged);
+        setChanged(totalUploaded, static_cast<long long>(torrentMap.value(totalUploadedKey).toDouble()), changedFields, TotalUploadedChanged);
+        setChanged(ratio, torrentMap.value(ratioKey).toDouble(), changedFields, RatioChanged);
 
         setChanged(ratioLimitMode, [&]() {
             switch (int mode = torrentMap.value(ratioLimitModeKey).toInt()) {
@@ -134,80 +272,54 @@ namespace libtremotesf
             default:
                 return GlobalRatioLimit;
             }
-        }(), changed);
-        setChanged(ratioLimit, torrentMap.value(ratioLimitKey).toDouble(), changed);
+        }(), changedFields, RatioLimitModeChanged);
+        setChanged(ratioLimit, torrentMap.value(ratioLimitKey).toDouble(), changedFields, RatioLimitChanged);
 
-        setChanged(seeders, torrentMap.value(seedersKey).toInt(), changed);
-        setChanged(leechers, torrentMap.value(leechersKey).toInt(), changed);
+        setChanged(seeders, torrentMap.value(seedersKey).toInt(), changedFields, SeedersChanged);
+        setChanged(leechers, torrentMap.value(leechersKey).toInt(), changedFields, LeechersChanged);
 
         const bool stalled = (seeders == 0 && leechers == 0);
         if (torrentMap.value(errorKey).toInt() == 0) {
             switch (torrentMap.value(statusKey).toInt()) {
             case 0:
-                setChanged(status, Paused, changed);
+                setChanged(status, Paused, changedFields, StatusChanged);
                 break;
             case 1:
-                setChanged(status, QueuedForChecking, changed);
+                setChanged(status, QueuedForChecking, changedFields, StatusChanged);
                 break;
             case 2:
-                setChanged(status, Checking, changed);
+                setChanged(status, Checking, changedFields, StatusChanged);
                 break;
             case 3:
-                setChanged(status, QueuedForDownloading, changed);
+                setChanged(status, QueuedForDownloading, changedFields, StatusChanged);
                 break;
             case 4:
                 if (stalled) {
-                    setChanged(status, StalledDownloading, changed);
+                    setChanged(status, StalledDownloading, changedFields, StatusChanged);
                 } else {
-                    setChanged(status, Downloading, changed);
+                    setChanged(status, Downloading, changedFields, StatusChanged);
                 }
                 break;
             case 5:
-                setChanged(status, QueuedForSeeding, changed);
+                setChanged(status, QueuedForSeeding, changedFields, StatusChanged);
                 break;
             case 6:
                 if (stalled) {
-                    setChanged(status, StalledSeeding, changed);
+                    setChanged(status, StalledSeeding, changedFields, StatusChanged);
                 } else {
-                    setChanged(status, Seeding, changed);
+                    setChanged(status, Seeding, changedFields, StatusChanged);
                 }
             }
         } else {
-            setChanged(status, Errored, changed);
+            setChanged(status, Errored, changedFields, StatusChanged);
         }
 
-        setChanged(peersLimit, torrentMap.value(peersLimitKey).toInt(), changed);
+        setChanged(peersLimit, torrentMap.value(peersLimitKey).toInt(), changedFields, PeersLimitChanged);
 
-        const long long newActivityDateTime = torrentMap.value(activityDateKey).toDouble() * 1000;
-        if (newActivityDateTime > 0) {
-            if (newActivityDateTime != activityDateTime) {
-                activityDateTime = newActivityDateTime;
-                activityDate.setMSecsSinceEpoch(newActivityDateTime);
-                changed = true;
-            }
-        } else {
-            if (!activityDate.isNull()) {
-                activityDateTime = -1;
-                activityDate = QDateTime();
-                changed = true;
-            }
-        }
-        const long long newDoneDateTime = torrentMap.value(doneDateKey).toDouble() * 1000;
-        if (newDoneDateTime > 0) {
-            if (newDoneDateTime != doneDateTime) {
-                doneDateTime = newDoneDateTime;
-                doneDate.setMSecsSinceEpoch(newDoneDateTime);
-                changed = true;
-            }
-        } else {
-            if (!doneDate.isNull()) {
-                doneDateTime = -1;
-                doneDate = QDateTime();
-                changed = true;
-            }
-        }
+        updateDate(activityDate, torrentMap.value(activityDateKey), changedFields, ActivityDateChanged);
+        updateDate(doneDate, torrentMap.value(doneDateKey), changedFields, DoneDateChanged);
 
-        setChanged(honorSessionLimits, torrentMap.value(honorSessionLimitsKey).toBool(), changed);
+        setChanged(honorSessionLimits, torrentMap.value(honorSessionLimitsKey).toBool(), changedFields, HonorSessionLimitsChanged);
         setChanged(bandwidthPriority, [&]() {
             switch (int priority = torrentMap.value(bandwidthPriorityKey).toInt()) {
             case LowPriority:
@@ -217,7 +329,7 @@ namespace libtremotesf
             default:
                 return NormalPriority;
             }
-        }(), changed);
+        }(), changedFields, BandwidthPriorityChanged);
         setChanged(idleSeedingLimitMode, [&]() {
             switch (int mode = torrentMap.value(idleSeedingLimitModeKey).toInt()) {
             case GlobalIdleSeedingLimit:
@@ -227,28 +339,15 @@ namespace libtremotesf
             default:
                 return GlobalIdleSeedingLimit;
             }
-        }(), changed);
-        setChanged(idleSeedingLimit, torrentMap.value(idleSeedingLimitKey).toInt(), changed);
-        setChanged(downloadDirectory, torrentMap.value(downloadDirectoryKey).toString(), changed);
-        setChanged(singleFile, torrentMap.value(prioritiesKey).toArray().size() == 1, changed);
-        setChanged(creator, torrentMap.value(creatorKey).toString(), changed);
-
-        const long long newCreationDateTime = torrentMap.value(creationDateKey).toDouble() * 1000;
-        if (newCreationDateTime > 0) {
-            if (newCreationDateTime != creationDateTime) {
-                creationDateTime = newCreationDateTime;
-                creationDate.setMSecsSinceEpoch(newCreationDateTime);
-                changed = true;
-            }
-        } else {
-            if (!creationDate.isNull()) {
-                creationDateTime = -1;
-                creationDate = QDateTime();
-                changed = true;
-            }
-        }
+        }(), changedFields, IdleSeedingLimitModeChanged);
+        setChanged(idleSeedingLimit, torrentMap.value(idleSeedingLimitKey).toInt(), changedFields, IdleSeedingLimitChanged);
+        setChanged(downloadDirectory, InternedString(torrentMap.value(downloadDirectoryKey).toString()), changedFields, DownloadDirectoryChanged);
+        setChanged(singleFile, torrentMap.value(prioritiesKey).toArray().size() == 1, changedFields, SingleFileChanged);
+        setChanged(creator, torrentMap.value(creatorKey).toString(), changedFields, CreatorChanged);
 
-        setChanged(comment, torrentMap.value(commentKey).toString(), changed);
+        updateDate(creationDate, torrentMap.value(creationDateKey), changedFields, CreationDateChanged);
+
+        setChanged(comment, torrentMap.value(commentKey).toString(), changedFields, CommentChanged);
 
         trackersAddedOrRemoved = false;
         std::vector<Tracker> newTrackers;
@@ -266,13 +365,20 @@ namespace libtremotesf
                 newTrackers.emplace_back(id, trackerMap);
                 trackersAddedOrRemoved = true;
             } else {
+                const InternedString site(found->internedSite());
                 found->update(trackerMap);
+                if (found->internedSite() != site) {
+                    changedFields |= TrackersChanged;
+                }
                 newTrackers.push_back(std::move(*found));
             }
         }
         if (newTrackers.size() != trackers.size()) {
             trackersAddedOrRemoved = true;
         }
+        if (trackersAddedOrRemoved) {
+            changedFields |= TrackersChanged;
+        }
         trackers = std::move(newTrackers);
     }
 
@@ -280,19 +386,31 @@ namespace libtremotesf
         : mRpc(rpc)
     {
         mData.id = id;
-        mData.hashString = torrentMap.value(hashStringKey).toString();
-        mData.addedDate = QDateTime::fromMSecsSinceEpoch(torrentMap.value(addedDateKey).toDouble() * 1000);
+        mData.hash = TorrentHash::fromHex(torrentMap.value(hashStringKey).toString());
+        mData.addedDate = static_cast<long long>(torrentMap.value(addedDateKey).toDouble()) * 1000;
         update(torrentMap);
     }
 
+    Torrent::Torrent(TorrentData&& data, Rpc* rpc)
+        : mRpc(rpc),
+          mData(std::move(data))
+    {
+
+    }
+
     int Torrent::id() const
     {
         return mData.id;
     }
 
-    const QString& Torrent::hashString() const
+    const TorrentHash& Torrent::hash() const
+    {
+        return mData.hash;
+    }
+
+    QString Torrent::hashString() const
     {
-        return mData.hashString;
+        return mData.hash.toHex();
     }
 
     const QString& Torrent::name() const
@@ -474,19 +592,19 @@ namespace libtremotesf
         mRpc->setTorrentProperty(id(), peersLimitKey, limit);
     }
 
-    const QDateTime& Torrent::addedDate() const
+    QDateTime Torrent::addedDate() const
     {
-        return mData.addedDate;
+        return dateTimeFromMSecs(mData.addedDate);
     }
 
-    const QDateTime& Torrent::activityDate() const
+    QDateTime Torrent::activityDate() const
     {
-        return mData.activityDate;
+        return dateTimeFromMSecs(mData.activityDate);
     }
 
-    const QDateTime& Torrent::doneDate() const
+    QDateTime Torrent::doneDate() const
     {
-        return mData.doneDate;
+        return dateTimeFromMSecs(mData.doneDate);
     }
 
     bool Torrent::honorSessionLimits() const
@@ -539,7 +657,7 @@ namespace libtremotesf
 
     const QString& Torrent::downloadDirectory() const
     {
-        return mData.downloadDirectory;
+        return mData.downloadDirectory.toString();
     }
 
     bool Torrent::isSingleFile() const
@@ -552,9 +670,9 @@ namespace libtremotesf
         return mData.creator;
     }
 
-    const QDateTime& Torrent::creationDate() const
+    QDateTime Torrent::creationDate() const
     {
-        return mData.creationDate;
+        return dateTimeFromMSecs(mData.creationDate);
     }
 
     const QString& Torrent::comment() const
@@ -589,7 +707,12 @@ namespace libtremotesf
 
     bool Torrent::isChanged() const
     {
-        return mData.changed;
+        return mData.changedFields != 0;
+    }
+
+    quint64 Torrent::changedFields() const
+    {
+        return mData.changedFields;
     }
 
     const TorrentData& Torrent::data() const
@@ -683,6 +806,11 @@ namespace libtremotesf
         return updated;
     }
 
+    void Torrent::setId(int id)
+    {
+        mData.id = id;
+    }
+
     void Torrent::update(const QJsonObject& torrentMap)
     {
         mData.update(torrentMap, mRpc);
@@ -723,14 +851,25 @@ namespace libtremotesf
 
     void Torrent::updatePeers(const QJsonObject &torrentMap)
     {
-        std::vector<std::tuple<QJsonObject, QString, bool>> newPeers;
+        struct NewPeer
+        {
+            QJsonObject json;
+            PeerKey key;
+            bool existing;
+        };
+
+        std::vector<NewPeer> newPeers;
+        std::unordered_map<PeerKey, size_t> newPeersIndexes;
         {
             const QJsonArray peerJsons(torrentMap.value(QJsonKeyStringInit("peers")).toArray());
             newPeers.reserve(static_cast<size_t>(peerJsons.size()));
+            newPeersIndexes.reserve(static_cast<size_t>(peerJsons.size()));
             for (const QJsonValue& peerValue : peerJsons) {
                 QJsonObject peerJson(peerValue.toObject());
-                QString address(peerJson.value(Peer::addressKey).toString());
-                newPeers.emplace_back(std::move(peerJson), std::move(address), false);
+                const PeerKey key(PeerKey::fromJson(peerJson));
+                if (newPeersIndexes.emplace(key, newPeers.size()).second) {
+                    newPeers.push_back({std::move(peerJson), key, false});
+                }
             }
         }
 
@@ -740,24 +879,42 @@ namespace libtremotesf
         }
         std::vector<int> changed;
         {
-            const auto newPeersBegin(newPeers.begin());
-            const auto newPeersEnd(newPeers.end());
-            VectorBatchRemover<Peer> remover(mPeers, &removed, &changed);
+            const auto newPeersIndexesEnd(newPeersIndexes.end());
             for (int i = static_cast<int>(mPeers.size()) - 1; i >= 0; --i) {
                 Peer& peer = mPeers[static_cast<size_t>(i)];
-                const auto found(std::find_if(newPeersBegin, newPeersEnd, [&peer](const auto& p) {
-                    return std::get<1>(p) == peer.address;
-                }));
-                if (found == newPeersEnd) {
-                    remover.remove(i);
+                const auto found(newPeersIndexes.find(peer.key));
+                if (found == newPeersIndexesEnd) {
+                    removed.push_back(i);
                 } else {
-                    std::get<2>(*found) = true;
-                    if (peer.update(std::get<0>(*found))) {
+                    NewPeer& newPeer = newPeers[found->second];
+                    newPeer.existing = true;
+                    if (peer.update(newPeer.json)) {
                         changed.push_back(i);
                     }
                 }
             }
-            remover.doRemove();
+
+            // Remove each range of consecutive peers separately so that models can
+            // emit rowsRemoved() while remaining peers are still at their indexes
+            size_t last = 0;
+            for (size_t i = 1, max = removed.size(); i <= max; ++i) {
+                if (i == max || removed[i] != (removed[i - 1] - 1)) {
+                    const int firstIndex = removed[i - 1];
+                    const int lastIndex = removed[last];
+                    emit peersAboutToBeRemoved(firstIndex, lastIndex);
+                    mPeers.erase(mPeers.begin() + firstIndex, mPeers.begin() + lastIndex + 1);
+                    // changed is in descending order
+                    const int shift = lastIndex - firstIndex + 1;
+                    for (int& index : changed) {
+                        if (index < firstIndex) {
+                            break;
+                        }
+                        index -= shift;
+                    }
+                    emit peersRemoved(firstIndex, lastIndex);
+                    last = i;
+                }
+            }
         }
         std::reverse(changed.begin(), changed.end());
 
@@ -765,12 +922,9 @@ namespace libtremotesf
         if (newPeers.size() > mPeers.size()) {
             added = static_cast<int>(newPeers.size() - mPeers.size());
             mPeers.reserve(newPeers.size());
-            for (auto& p : newPeers) {
-                const QJsonObject& peerJson = std::get<0>(p);
-                QString& address = std::get<1>(p);
-                const bool existing = std::get<2>(p);
-                if (!existing) {
-                    mPeers.emplace_back(std::move(address), peerJson);
+            for (const NewPeer& newPeer : newPeers) {
+                if (!newPeer.existing) {
+                    mPeers.emplace_back(newPeer.key, newPeer.json);
                 }
             }
         }
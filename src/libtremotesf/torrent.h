@@ -24,11 +24,14 @@
 #include <QDateTime>
 #include <QObject>
 
+#include "internedstring.h"
 #include "peer.h"
 #include "stdutils.h"
 #include "torrentfile.h"
+#include "torrenthash.h"
 #include "tracker.h"
 
+class QDataStream;
 class QJsonObject;
 
 namespace libtremotesf
@@ -78,10 +81,54 @@ namespace libtremotesf
         };
         Q_ENUM(IdleSeedingLimitMode)
 
+        // Bits of changedFields
+        enum ChangedField : quint64
+        {
+            NameChanged = 1ULL << 0,
+            ErrorStringChanged = 1ULL << 1,
+            StatusChanged = 1ULL << 2,
+            QueuePositionChanged = 1ULL << 3,
+            TotalSizeChanged = 1ULL << 4,
+            CompletedSizeChanged = 1ULL << 5,
+            LeftUntilDoneChanged = 1ULL << 6,
+            SizeWhenDoneChanged = 1ULL << 7,
+            PercentDoneChanged = 1ULL << 8,
+            RecheckProgressChanged = 1ULL << 9,
+            EtaChanged = 1ULL << 10,
+            DownloadSpeedChanged = 1ULL << 11,
+            UploadSpeedChanged = 1ULL << 12,
+            DownloadSpeedLimitedChanged = 1ULL << 13,
+            DownloadSpeedLimitChanged = 1ULL << 14,
+            UploadSpeedLimitedChanged = 1ULL << 15,
+            UploadSpeedLimitChanged = 1ULL << 16,
+            TotalDownloadedChanged = 1ULL << 17,
+            TotalUploadedChanged = 1ULL << 18,
+            RatioChanged = 1ULL << 19,
+            RatioLimitChanged = 1ULL << 20,
+            RatioLimitModeChanged = 1ULL << 21,
+            SeedersChanged = 1ULL << 22,
+            LeechersChanged = 1ULL << 23,
+            PeersLimitChanged = 1ULL << 24,
+            AddedDateChanged = 1ULL << 25,
+            ActivityDateChanged = 1ULL << 26,
+            DoneDateChanged = 1ULL << 27,
+            IdleSeedingLimitModeChanged = 1ULL << 28,
+            IdleSeedingLimitChanged = 1ULL << 29,
+            DownloadDirectoryChanged = 1ULL << 30,
+            CommentChanged = 1ULL << 31,
+            CreatorChanged = 1ULL << 32,
+            CreationDateChanged = 1ULL << 33,
+            BandwidthPriorityChanged = 1ULL << 34,
+            HonorSessionLimitsChanged = 1ULL << 35,
+            SingleFileChanged = 1ULL << 36,
+            TrackersChanged = 1ULL << 37,
+            AllChanged = (1ULL << 38) - 1
+        };
+
         void update(const QJsonObject& torrentMap, const Rpc* rpc);
 
         int id = 0;
-        QString hashString;
+        TorrentHash hash;
         QString name;
 
         QString errorString;
@@ -114,30 +161,31 @@ namespace libtremotesf
         int leechers = 0;
         int peersLimit = 0;
 
-        QDateTime addedDate;
-        QDateTime activityDate;
-        long long activityDateTime = -1;
-        QDateTime doneDate;
-        long long doneDateTime = -1;
+        // Milliseconds since epoch, -1 if not set
+        long long addedDate = -1;
+        long long activityDate = -1;
+        long long doneDate = -1;
 
         IdleSeedingLimitMode idleSeedingLimitMode = GlobalIdleSeedingLimit;
         int idleSeedingLimit = 0;
-        QString downloadDirectory;
+        InternedString downloadDirectory;
         QString comment;
         QString creator;
-        QDateTime creationDate;
-        long long creationDateTime = -1;
+        long long creationDate = -1;
         Priority bandwidthPriority = NormalPriority;
         bool honorSessionLimits = false;
         bool singleFile = false;
 
         bool trackersAddedOrRemoved = false;
 
-        bool changed;
+        quint64 changedFields = 0;
 
         std::vector<Tracker> trackers;
     };
 
+    QDataStream& operator<<(QDataStream& stream, const TorrentData& data);
+    QDataStream& operator>>(QDataStream& stream, TorrentData& data);
+
     class Torrent : public QObject
     {
         Q_OBJECT
@@ -200,9 +248,11 @@ namespace libtremotesf
         static const QJsonKeyString idKey;
 
         explicit Torrent(int id, const QJsonObject& torrentMap, Rpc* rpc);
+        explicit Torrent(TorrentData&& data, Rpc* rpc);
 
         int id() const;
-        const QString& hashString() const;
+        const TorrentHash& hash() const;
+        QString hashString() const;
         const QString& name() const;
 
         Status status() const;
@@ -244,9 +294,9 @@ namespace libtremotesf
         int peersLimit() const;
         Q_INVOKABLE void setPeersLimit(int limit);
 
-        const QDateTime& addedDate() const;
-        const QDateTime& activityDate() const;
-        const QDateTime& doneDate() const;
+        QDateTime addedDate() const;
+        QDateTime activityDate() const;
+        QDateTime doneDate() const;
 
         bool honorSessionLimits() const;
         Q_INVOKABLE void setHonorSessionLimits(bool honor);
@@ -259,7 +309,7 @@ namespace libtremotesf
         const QString& downloadDirectory() const;
         bool isSingleFile() const;
         const QString& creator() const;
-        const QDateTime& creationDate() const;
+        QDateTime creationDate() const;
         const QString& comment() const;
 
         const std::vector<Tracker>& trackers() const;
@@ -269,6 +319,7 @@ namespace libtremotesf
         Q_INVOKABLE void removeTrackers(const QVariantList& ids);
 
         bool isChanged() const;
+        quint64 changedFields() const;
 
         const TorrentData& data() const;
 
@@ -286,6 +337,8 @@ namespace libtremotesf
 
         bool isUpdated() const;
 
+        // Ids change when daemon is restarted, used for torrents restored from snapshot
+        void setId(int id);
         void update(const QJsonObject& torrentMap);
         void updateFiles(const QJsonObject& torrentMap);
         void updatePeers(const QJsonObject& torrentMap);
@@ -305,6 +358,10 @@ namespace libtremotesf
     signals:
         void updated();
         void filesUpdated(const std::vector<int>& changed);
+        // Emitted around removal of each range of consecutive peers, before peersUpdated()
+        void peersAboutToBeRemoved(int first, int last);
+        void peersRemoved(int first, int last);
+        // Indexes in changed are after removal
         void peersUpdated(const std::vector<int>& removed, const std::vector<int>& changed, int added);
         void fileRenamed(const QString& filePath, const QString& newName);
         void limitsEdited();
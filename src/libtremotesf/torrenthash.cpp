@@ -0,0 +1,101 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "torrenthash.h"
+
+#include <QDataStream>
+
+namespace libtremotesf
+{
+    namespace
+    {
+        inline int hexDigitValue(ushort c)
+        {
+            if (c >= '0' && c <= '9') {
+                return c - '0';
+            }
+            if (c >= 'a' && c <= 'f') {
+                return c - 'a' + 10;
+            }
+            if (c >= 'A' && c <= 'F') {
+                return c - 'A' + 10;
+            }
+            return -1;
+        }
+    }
+
+    TorrentHash TorrentHash::fromHex(const QString& hex)
+    {
+        const int size = hex.size() / 2;
+        if ((size != v1Size && size != v2Size) || (hex.size() % 2) != 0) {
+            return TorrentHash();
+        }
+
+        TorrentHash hash;
+        const QChar* chars = hex.constData();
+        for (int i = 0; i < size; ++i) {
+            const int high = hexDigitValue(chars[2 * i].unicode());
+            const int low = hexDigitValue(chars[2 * i + 1].unicode());
+            if (high == -1 || low == -1) {
+                return TorrentHash();
+            }
+            hash.mData[static_cast<size_t>(i)] = static_cast<char>((high << 4) | low);
+        }
+        hash.mSize = size;
+        return hash;
+    }
+
+    QString TorrentHash::toHex() const
+    {
+        static const char digits[] = "0123456789abcdef";
+        QString hex(mSize * 2, Qt::Uninitialized);
+        QChar* chars = hex.data();
+        for (int i = 0; i < mSize; ++i) {
+            const auto byte = static_cast<uchar>(mData[static_cast<size_t>(i)]);
+            chars[2 * i] = QLatin1Char(digits[byte >> 4]);
+            chars[2 * i + 1] = QLatin1Char(digits[byte & 0xf]);
+        }
+        return hex;
+    }
+
+    QDataStream& operator<<(QDataStream& stream, const TorrentHash& hash)
+    {
+        stream << static_cast<quint8>(hash.mSize);
+        stream.writeRawData(hash.mData.data(), hash.mSize);
+        return stream;
+    }
+
+    QDataStream& operator>>(QDataStream& stream, TorrentHash& hash)
+    {
+        quint8 size;
+        stream >> size;
+        if (size != 0 && size != TorrentHash::v1Size && size != TorrentHash::v2Size) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            hash = TorrentHash();
+            return stream;
+        }
+        hash = TorrentHash();
+        if (stream.readRawData(hash.mData.data(), size) != size) {
+            stream.setStatus(QDataStream::ReadPastEnd);
+            return stream;
+        }
+        hash.mSize = size;
+        return stream;
+    }
+}
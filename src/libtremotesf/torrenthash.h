@@ -0,0 +1,97 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTREMOTESF_TORRENTHASH_H
+#define LIBTREMOTESF_TORRENTHASH_H
+
+#include <array>
+#include <cstring>
+#include <functional>
+
+#include <QHashFunctions>
+#include <QString>
+
+class QDataStream;
+
+namespace libtremotesf
+{
+    // Binary infohash of torrent (SHA-1 or SHA-256 for BitTorrent v2)
+    class TorrentHash
+    {
+    public:
+        static const int v1Size = 20;
+        static const int v2Size = 32;
+
+        TorrentHash() = default;
+
+        // Returns null hash if string is not a valid hex-encoded hash
+        static TorrentHash fromHex(const QString& hex);
+
+        bool isNull() const { return mSize == 0; }
+        int size() const { return mSize; }
+        const char* data() const { return mData.data(); }
+
+        QString toHex() const;
+
+        inline bool operator==(const TorrentHash& other) const
+        {
+            return mSize == other.mSize && std::memcmp(mData.data(), other.mData.data(), static_cast<size_t>(mSize)) == 0;
+        }
+
+        inline bool operator!=(const TorrentHash& other) const
+        {
+            return !(*this == other);
+        }
+
+        inline bool operator<(const TorrentHash& other) const
+        {
+            const int result = std::memcmp(mData.data(), other.mData.data(), v2Size);
+            return result < 0 || (result == 0 && mSize < other.mSize);
+        }
+
+        friend QDataStream& operator<<(QDataStream& stream, const TorrentHash& hash);
+        friend QDataStream& operator>>(QDataStream& stream, TorrentHash& hash);
+
+    private:
+        std::array<char, v2Size> mData{};
+        int mSize = 0;
+    };
+
+    inline uint qHash(const TorrentHash& hash, uint seed = 0) noexcept
+    {
+        return qHashBits(hash.data(), static_cast<size_t>(hash.size()), seed);
+    }
+}
+
+namespace std
+{
+    template<>
+    struct hash<libtremotesf::TorrentHash>
+    {
+        size_t operator()(const libtremotesf::TorrentHash& hash) const noexcept
+        {
+            // Hash is already a uniformly distributed value
+            size_t result;
+            std::memcpy(&result, hash.data(), sizeof(result));
+            return result;
+        }
+    };
+}
+
+#endif // LIBTREMOTESF_TORRENTHASH_H
@@ -0,0 +1,136 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "torrentscolumns.h"
+
+namespace libtremotesf
+{
+    namespace
+    {
+        template<typename T>
+        void removeIndexes(std::vector<T>& column, const std::vector<int>& removed)
+        {
+            // Single pass over the column instead of erasing every index separately
+            auto removedIterator = removed.rbegin();
+            const auto removedEnd = removed.rend();
+            size_t destination = static_cast<size_t>(*removedIterator);
+            for (size_t source = destination, max = column.size(); source < max; ++source) {
+                if (removedIterator != removedEnd && source == static_cast<size_t>(*removedIterator)) {
+                    ++removedIterator;
+                } else {
+                    column[destination] = std::move(column[source]);
+                    ++destination;
+                }
+            }
+            column.resize(destination);
+        }
+
+        template<typename Function>
+        void forEachColumn(TorrentsColumns& columns, Function function)
+        {
+            function(columns.status);
+            function(columns.queuePosition);
+            function(columns.totalSize);
+            function(columns.completedSize);
+            function(columns.leftUntilDone);
+            function(columns.sizeWhenDone);
+            function(columns.percentDone);
+            function(columns.recheckProgress);
+            function(columns.eta);
+            function(columns.downloadSpeed);
+            function(columns.uploadSpeed);
+            function(columns.totalDownloaded);
+            function(columns.totalUploaded);
+            function(columns.ratio);
+            function(columns.seeders);
+            function(columns.leechers);
+            function(columns.addedDate);
+            function(columns.activityDate);
+            function(columns.doneDate);
+            function(columns.downloadDirectory);
+        }
+    }
+
+    size_t TorrentsColumns::size() const
+    {
+        return status.size();
+    }
+
+    void TorrentsColumns::clear()
+    {
+        name.clear();
+        forEachColumn(*this, [](auto& column) {
+            column.clear();
+        });
+    }
+
+    void TorrentsColumns::append(const TorrentData& data)
+    {
+        name.append(QString());
+        forEachColumn(*this, [](auto& column) {
+            column.emplace_back();
+        });
+        set(size() - 1, data);
+    }
+
+    void TorrentsColumns::set(size_t row, const TorrentData& data, quint64 changedFields)
+    {
+        if (changedFields & TorrentData::NameChanged) {
+            name.set(row, data.name);
+        }
+
+        status[row] = data.status;
+        queuePosition[row] = data.queuePosition;
+
+        totalSize[row] = data.totalSize;
+        completedSize[row] = data.completedSize;
+        leftUntilDone[row] = data.leftUntilDone;
+        sizeWhenDone[row] = data.sizeWhenDone;
+        percentDone[row] = data.percentDone;
+        recheckProgress[row] = data.recheckProgress;
+        eta[row] = data.eta;
+
+        downloadSpeed[row] = data.downloadSpeed;
+        uploadSpeed[row] = data.uploadSpeed;
+
+        totalDownloaded[row] = data.totalDownloaded;
+        totalUploaded[row] = data.totalUploaded;
+        ratio[row] = data.ratio;
+
+        seeders[row] = data.seeders;
+        leechers[row] = data.leechers;
+
+        addedDate[row] = data.addedDate;
+        activityDate[row] = data.activityDate;
+        doneDate[row] = data.doneDate;
+
+        downloadDirectory[row] = data.downloadDirectory.id();
+    }
+
+    void TorrentsColumns::remove(const std::vector<int>& removed)
+    {
+        if (removed.empty()) {
+            return;
+        }
+        name.remove(removed);
+        forEachColumn(*this, [&removed](auto& column) {
+            removeIndexes(column, removed);
+        });
+    }
+}
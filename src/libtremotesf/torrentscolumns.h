@@ -0,0 +1,76 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTREMOTESF_TORRENTSCOLUMNS_H
+#define LIBTREMOTESF_TORRENTSCOLUMNS_H
+
+#include <vector>
+
+#include "torrent.h"
+#include "torrentsnameindex.h"
+
+namespace libtremotesf
+{
+    // Frequently scanned torrents' fields stored in contiguous arrays,
+    // indexes are the same as in Rpc::torrents()
+    struct TorrentsColumns
+    {
+        size_t size() const;
+
+        void clear();
+        void append(const TorrentData& data);
+        // Name is updated only if changedFields has TorrentData::NameChanged
+        void set(size_t row, const TorrentData& data, quint64 changedFields = TorrentData::AllChanged);
+        // Indexes must be sorted in descending order, like in Rpc::torrentsUpdated()
+        void remove(const std::vector<int>& removed);
+
+        TorrentsNameIndex name;
+
+        std::vector<TorrentData::Status> status;
+        std::vector<int> queuePosition;
+
+        std::vector<long long> totalSize;
+        std::vector<long long> completedSize;
+        std::vector<long long> leftUntilDone;
+        std::vector<long long> sizeWhenDone;
+        std::vector<double> percentDone;
+        std::vector<double> recheckProgress;
+        std::vector<int> eta;
+
+        std::vector<long long> downloadSpeed;
+        std::vector<long long> uploadSpeed;
+
+        std::vector<long long> totalDownloaded;
+        std::vector<long long> totalUploaded;
+        std::vector<double> ratio;
+
+        std::vector<int> seeders;
+        std::vector<int> leechers;
+
+        // Milliseconds since epoch, -1 if not set
+        std::vector<long long> addedDate;
+        std::vector<long long> activityDate;
+        std::vector<long long> doneDate;
+
+        // InternedString ids
+        std::vector<int> downloadDirectory;
+    };
+}
+
+#endif // LIBTREMOTESF_TORRENTSCOLUMNS_H
@@ -0,0 +1,138 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "torrentsnameindex.h"
+
+#include <algorithm>
+
+namespace libtremotesf
+{
+    namespace
+    {
+        const int trigramLength = 3;
+
+        quint64 trigrams(const QChar* string, int length)
+        {
+            quint64 bits = 0;
+            for (int i = 0, max = length - trigramLength + 1; i < max; ++i) {
+                const quint64 trigram = (quint64(string[i].unicode()) << 32) |
+                                        (quint64(string[i + 1].unicode()) << 16) |
+                                        quint64(string[i + 2].unicode());
+                // Fibonacci hashing to one of 64 bits
+                bits |= (quint64(1) << ((trigram * 11400714819323198485ull) >> 58));
+            }
+            return bits;
+        }
+    }
+
+    TorrentsNameIndex::Query::Query(const QString& string)
+        : string(string.toCaseFolded()),
+          trigrams(libtremotesf::trigrams(this->string.constData(), this->string.size()))
+    {
+    }
+
+    size_t TorrentsNameIndex::size() const
+    {
+        return mEntries.size();
+    }
+
+    void TorrentsNameIndex::clear()
+    {
+        mNames.clear();
+        mEntries.clear();
+        mUnused = 0;
+    }
+
+    void TorrentsNameIndex::append(const QString& name)
+    {
+        mEntries.push_back({mNames.size(), 0, 0});
+        setFolded(mEntries.size() - 1, name);
+    }
+
+    void TorrentsNameIndex::set(size_t row, const QString& name)
+    {
+        setFolded(row, name);
+    }
+
+    void TorrentsNameIndex::setFolded(size_t row, const QString& name)
+    {
+        const QString folded(name.toCaseFolded());
+        Entry& entry = mEntries[row];
+        if (folded.size() <= entry.length) {
+            std::copy(folded.begin(), folded.end(), mNames.begin() + entry.offset);
+            mUnused += entry.length - folded.size();
+        } else {
+            mUnused += entry.length;
+            entry.offset = mNames.size();
+            mNames.append(folded);
+        }
+        entry.length = folded.size();
+        entry.trigrams = trigrams(folded.constData(), folded.size());
+
+        if (mUnused > mNames.size() / 2) {
+            compact();
+        }
+    }
+
+    void TorrentsNameIndex::remove(const std::vector<int>& removed)
+    {
+        if (removed.empty()) {
+            return;
+        }
+        auto removedIterator = removed.rbegin();
+        const auto removedEnd = removed.rend();
+        size_t destination = static_cast<size_t>(*removedIterator);
+        for (size_t source = destination, max = mEntries.size(); source < max; ++source) {
+            if (removedIterator != removedEnd && source == static_cast<size_t>(*removedIterator)) {
+                mUnused += mEntries[source].length;
+                ++removedIterator;
+            } else {
+                mEntries[destination] = mEntries[source];
+                ++destination;
+            }
+        }
+        mEntries.resize(destination);
+
+        if (mUnused > mNames.size() / 2) {
+            compact();
+        }
+    }
+
+    bool TorrentsNameIndex::contains(size_t row, const Query& query) const
+    {
+        const Entry& entry = mEntries[row];
+        if ((entry.trigrams & query.trigrams) != query.trigrams) {
+            return false;
+        }
+        return QStringRef(&mNames, entry.offset, entry.length).contains(query.string);
+    }
+
+    void TorrentsNameIndex::compact()
+    {
+        QString names;
+        names.reserve(mNames.size() - mUnused);
+        for (Entry& entry : mEntries) {
+            const int offset = names.size();
+            names.append(mNames.constData() + entry.offset, entry.length);
+            entry.offset = offset;
+        }
+        mNames = std::move(names);
+        mUnused = 0;
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTREMOTESF_TORRENTSNAMEINDEX_H
+#define LIBTREMOTESF_TORRENTSNAMEINDEX_H
+
+#include <vector>
+
+#include <QString>
+
+namespace libtremotesf
+{
+    // Case folded torrents' names stored in a single string,
+    // indexes are the same as in Rpc::torrents()
+    class TorrentsNameIndex
+    {
+    public:
+        struct Query
+        {
+            explicit Query(const QString& string = QString());
+
+            QString string;
+            // Bits of trigrams of string, empty if string is too short
+            quint64 trigrams;
+        };
+
+        size_t size() const;
+
+        void clear();
+        void append(const QString& name);
+        void set(size_t row, const QString& name);
+        // Indexes must be sorted in descending order, like in Rpc::torrentsUpdated()
+        void remove(const std::vector<int>& removed);
+
+        bool contains(size_t row, const Query& query) const;
+
+    private:
+        struct Entry
+        {
+            int offset;
+            int length;
+            quint64 trigrams;
+        };
+
+        void setFolded(size_t row, const QString& name);
+        void compact();
+
+        QString mNames;
+        std::vector<Entry> mEntries;
+        // Length of parts of mNames that are not used by entries
+        int mUnused = 0;
+    };
+}
+
+#endif // LIBTREMOTESF_TORRENTSNAMEINDEX_H
@@ -19,6 +19,7 @@
 #include "tracker.h"
 
 #include <QCoreApplication>
+#include <QDataStream>
 #include <QDateTime>
 #include <QJsonObject>
 #include <QUrl>
@@ -44,6 +45,11 @@ namespace libtremotesf
     }
 
     const QString& Tracker::site() const
+    {
+        return mSite.toString();
+    }
+
+    const InternedString& Tracker::internedSite() const
     {
         return mSite;
     }
@@ -74,11 +80,12 @@ namespace libtremotesf
         if (announce != mAnnounce) {
             mAnnounce = std::move(announce);
             const QUrl url(mAnnounce);
-            mSite = url.host();
+            QString site(url.host());
             const int topLevelDomainSize = url.topLevelDomain().size();
             if (topLevelDomainSize > 0) {
-                mSite.remove(0, mSite.lastIndexOf(QLatin1Char('.'), -1 - topLevelDomainSize) + 1);
+                site.remove(0, site.lastIndexOf(QLatin1Char('.'), -1 - topLevelDomainSize) + 1);
             }
+            mSite = InternedString(site);
         }
 
         const bool scrapeError = (!trackerMap.value(QJsonKeyStringInit("lastScrapeSucceeded")).toBool() &&
@@ -118,4 +125,29 @@ namespace libtremotesf
             mNextUpdate = nextUpdate;
         }
     }
+
+    QDataStream& operator<<(QDataStream& stream, const Tracker& tracker)
+    {
+        return stream << tracker.mId
+                      << tracker.mAnnounce
+                      << tracker.mSite
+                      << static_cast<qint32>(tracker.mStatus)
+                      << tracker.mErrorMessage
+                      << tracker.mPeers
+                      << tracker.mNextUpdate;
+    }
+
+    QDataStream& operator>>(QDataStream& stream, Tracker& tracker)
+    {
+        qint32 status;
+        stream >> tracker.mId
+               >> tracker.mAnnounce
+               >> tracker.mSite
+               >> status
+               >> tracker.mErrorMessage
+               >> tracker.mPeers
+               >> tracker.mNextUpdate;
+        tracker.mStatus = static_cast<Tracker::Status>(status);
+        return stream;
+    }
 }
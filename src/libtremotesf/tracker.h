@@ -21,6 +21,9 @@
 
 #include <QString>
 
+#include "internedstring.h"
+
+class QDataStream;
 class QJsonObject;
 
 namespace libtremotesf
@@ -37,11 +40,13 @@ namespace libtremotesf
             Error
         };
 
+        Tracker() = default;
         explicit Tracker(int id, const QJsonObject& trackerMap);
 
         int id() const;
         const QString& announce() const;
         const QString& site() const;
+        const InternedString& internedSite() const;
 
         Status status() const;
         QString errorMessage() const;
@@ -56,10 +61,13 @@ namespace libtremotesf
             return id() == other.id();
         }
 
+        friend QDataStream& operator<<(QDataStream& stream, const Tracker& tracker);
+        friend QDataStream& operator>>(QDataStream& stream, Tracker& tracker);
+
     private:
-        int mId;
+        int mId = 0;
         QString mAnnounce;
-        QString mSite;
+        InternedString mSite;
 
         Status mStatus = Inactive;
         QString mErrorMessage;
@@ -0,0 +1,146 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pathexistencecache.h"
+
+#include <vector>
+
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QtConcurrentRun>
+
+namespace tremotesf
+{
+    namespace
+    {
+        const qint64 maxResultAge = 10000; // ms
+
+        QString parentDirectory(const QString& path)
+        {
+            const int index = path.lastIndexOf(QLatin1Char('/'));
+            if (index <= 0) {
+                return QString();
+            }
+            return path.left(index);
+        }
+    }
+
+    PathExistenceCache::PathExistenceCache(QObject* parent)
+        : QObject(parent),
+          mCheckScheduled(false)
+    {
+        mElapsedTimer.start();
+        mThreadPool.setMaxThreadCount(1);
+        QObject::connect(&mWatcher, &QFileSystemWatcher::directoryChanged, this, &PathExistenceCache::onDirectoryChanged);
+    }
+
+    bool PathExistenceCache::exists(const QString& path)
+    {
+        auto found(mEntries.find(path));
+        if (found == mEntries.end()) {
+            found = mEntries.insert(path, {false, false, 0});
+            scheduleCheck(path, *found);
+        } else if (!found->checking && (mElapsedTimer.elapsed() - found->checkTime) > maxResultAge) {
+            scheduleCheck(path, *found);
+        }
+        return found->exists;
+    }
+
+    void PathExistenceCache::clear()
+    {
+        mEntries.clear();
+        mPendingPaths.clear();
+        if (!mWatchedDirectories.isEmpty()) {
+            mWatcher.removePaths(mWatchedDirectories.toList());
+            mWatchedDirectories.clear();
+        }
+    }
+
+    void PathExistenceCache::scheduleCheck(const QString& path, Entry& entry)
+    {
+        entry.checking = true;
+        mPendingPaths.push_back(path);
+        if (!mCheckScheduled) {
+            mCheckScheduled = true;
+            QTimer::singleShot(0, this, &PathExistenceCache::checkPendingPaths);
+        }
+    }
+
+    void PathExistenceCache::checkPendingPaths()
+    {
+        mCheckScheduled = false;
+        if (mPendingPaths.isEmpty()) {
+            return;
+        }
+
+        const QStringList paths(mPendingPaths);
+        mPendingPaths.clear();
+
+        auto watcher = new QFutureWatcher<std::vector<char>>(this);
+        QObject::connect(watcher, &QFutureWatcher<std::vector<char>>::finished, this, [=]() {
+            const std::vector<char> results(watcher->result());
+            watcher->deleteLater();
+
+            bool changed = false;
+            for (int i = 0, max = paths.size(); i < max; ++i) {
+                const QString& path = paths[i];
+                const auto found(mEntries.find(path));
+                // Entry may have been removed by clear()
+                if (found == mEntries.end() || !found->checking) {
+                    continue;
+                }
+                const bool exists = results[static_cast<size_t>(i)];
+                found->checking = false;
+                found->checkTime = mElapsedTimer.elapsed();
+                if (exists != found->exists) {
+                    found->exists = exists;
+                    changed = true;
+                }
+                if (exists) {
+                    const QString directory(parentDirectory(path));
+                    if (!directory.isEmpty() && !mWatchedDirectories.contains(directory)) {
+                        mWatchedDirectories.insert(directory);
+                        mWatcher.addPath(directory);
+                    }
+                }
+            }
+
+            if (changed) {
+                emit this->changed();
+            }
+        });
+        watcher->setFuture(QtConcurrent::run(&mThreadPool, [paths]() {
+            std::vector<char> results;
+            results.reserve(static_cast<size_t>(paths.size()));
+            for (const QString& path : paths) {
+                results.push_back(QFileInfo::exists(path));
+            }
+            return results;
+        }));
+    }
+
+    void PathExistenceCache::onDirectoryChanged(const QString& directory)
+    {
+        for (auto i = mEntries.begin(), end = mEntries.end(); i != end; ++i) {
+            if (!i->checking && parentDirectory(i.key()) == directory) {
+                scheduleCheck(i.key(), *i);
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TREMOTESF_PATHEXISTENCECACHE_H
+#define TREMOTESF_PATHEXISTENCECACHE_H
+
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+
+namespace tremotesf
+{
+    // Results of QFileInfo::exists() for local paths, checked in background thread.
+    // Parent directories of existing paths are watched, other paths are checked again after timeout
+    class PathExistenceCache : public QObject
+    {
+        Q_OBJECT
+    public:
+        explicit PathExistenceCache(QObject* parent = nullptr);
+
+        // Returns last known result, path that was not checked yet is reported as not existing.
+        // changed() is emitted when background check returns different result
+        bool exists(const QString& path);
+        void clear();
+
+    private:
+        struct Entry
+        {
+            bool exists;
+            bool checking;
+            qint64 checkTime;
+        };
+
+        void scheduleCheck(const QString& path, Entry& entry);
+        void checkPendingPaths();
+        void onDirectoryChanged(const QString& directory);
+
+        QHash<QString, Entry> mEntries;
+        QStringList mPendingPaths;
+        bool mCheckScheduled;
+        QFileSystemWatcher mWatcher;
+        QSet<QString> mWatchedDirectories;
+        QElapsedTimer mElapsedTimer;
+        // Checks may block for a long time on network filesystems, don't occupy global thread pool
+        QThreadPool mThreadPool;
+
+    signals:
+        void changed();
+    };
+}
+
+#endif // TREMOTESF_PATHEXISTENCECACHE_H
@@ -35,6 +35,7 @@ namespace tremotesf
     PeersModel::PeersModel(libtremotesf::Torrent* torrent, QObject* parent)
         : QAbstractTableModel(parent),
           mTorrent(nullptr),
+          mPeersCount(0),
           mLoaded(false)
     {
         setTorrent(torrent);
@@ -58,11 +59,20 @@ namespace tremotesf
 
     QVariant PeersModel::data(const QModelIndex& index, int role) const
     {
-        const libtremotesf::Peer& peer = mPeers[index.row()];
+        if (!mTorrent) {
+            return QVariant();
+        }
+        const auto& peers = mTorrent->peers();
+        const auto row = static_cast<size_t>(index.row());
+        // Added peers are stored in torrent before rows are inserted
+        if (row >= peers.size()) {
+            return QVariant();
+        }
+        const libtremotesf::Peer& peer = peers[row];
 #ifdef TREMOTESF_SAILFISHOS
         switch (role) {
         case Address:
-            return peer.address;
+            return peer.address();
         case DownloadSpeed:
             return peer.downloadSpeed;
         case UploadSpeed:
@@ -70,16 +80,16 @@ namespace tremotesf
         case Progress:
             return peer.progress;
         case Flags:
-            return peer.flags;
+            return peer.flagsString();
         case Client:
-            return peer.client;
+            return peer.client.toString();
         }
 #else
         switch (role) {
         case Qt::DisplayRole:
             switch (index.column()) {
             case AddressColumn:
-                return peer.address;
+                return peer.address();
             case DownloadSpeedColumn:
                 return Utils::formatByteSpeed(peer.downloadSpeed);
             case UploadSpeedColumn:
@@ -87,9 +97,9 @@ namespace tremotesf
             case ProgressColumn:
                 return Utils::formatProgress(peer.progress);
             case FlagsColumn:
-                return peer.flags;
+                return peer.flagsString();
             case ClientColumn:
-                return peer.client;
+                return peer.client.toString();
             }
             break;
         case SortRole:
@@ -136,7 +146,7 @@ namespace tremotesf
 
     int PeersModel::rowCount(const QModelIndex&) const
     {
-        return mPeers.size();
+        return mPeersCount;
     }
 
     libtremotesf::Torrent* PeersModel::torrent() const
@@ -147,18 +157,29 @@ namespace tremotesf
     void PeersModel::setTorrent(libtremotesf::Torrent* torrent)
     {
         if (torrent != mTorrent) {
+            if (mTorrent) {
+                QObject::disconnect(mTorrent.data(), nullptr, this, nullptr);
+                mTorrent->setPeersEnabled(false);
+            }
+
+            beginResetModel();
             mTorrent = torrent;
+            mPeersCount = 0;
+            endResetModel();
 
             if (mTorrent) {
-                QObject::connect(mTorrent, &libtremotesf::Torrent::peersUpdated, this, &PeersModel::update);
+                QObject::connect(mTorrent.data(), &libtremotesf::Torrent::peersAboutToBeRemoved, this, [=](int first, int last) {
+                    beginRemoveRows(QModelIndex(), first, last);
+                });
+                QObject::connect(mTorrent.data(), &libtremotesf::Torrent::peersRemoved, this, [=](int first, int last) {
+                    mPeersCount -= (last - first + 1);
+                    endRemoveRows();
+                });
+                QObject::connect(mTorrent.data(), &libtremotesf::Torrent::peersUpdated, this, &PeersModel::update);
                 if (mTorrent->isPeersEnabled()) {
-                    qWarning() << mTorrent << "already has enabled peers, this shouldn't happen";
+                    qWarning() << mTorrent.data() << "already has enabled peers, this shouldn't happen";
                 }
                 mTorrent->setPeersEnabled(true);
-            } else {
-                beginResetModel();
-                mPeers.clear();
-                endResetModel();
             }
         }
     }
@@ -180,36 +201,22 @@ namespace tremotesf
     }
 #endif
 
-    void PeersModel::update(const std::vector<int>& removed, const std::vector<int>& changed, int added)
+    void PeersModel::update(const std::vector<int>&, const std::vector<int>& changed, int added)
     {
-        if (!removed.empty()) {
-            ModelBatchRemover remover{this};
-            for (int index : removed) {
-                remover.remove(index);
-            }
-            remover.remove();
-        }
-
-        const auto& newPeers = mTorrent->peers();
-
+        // Removed rows are already removed in response to Torrent::peersRemoved()
         if (!changed.empty()) {
             ModelBatchChanger changer{this};
             for (int index : changed) {
-                const size_t i = static_cast<size_t>(index);
-                mPeers[i] = newPeers[i];
                 changer.changed(index);
             }
             changer.changed();
         }
 
         if (added > 0) {
-            const int first = static_cast<int>(mPeers.size());
+            const int first = mPeersCount;
             const int last = first + added - 1;
             beginInsertRows(QModelIndex(), first, last);
-            mPeers.reserve(static_cast<size_t>(last + 1));
-            for (auto end = newPeers.end(), i = end - added; i != end; ++i) {
-                mPeers.push_back(*i);
-            }
+            mPeersCount += added;
             endInsertRows();
         }
     }
@@ -22,8 +22,7 @@
 #include <vector>
 
 #include <QAbstractTableModel>
-
-#include "libtremotesf/peer.h"
+#include <QPointer>
 
 namespace libtremotesf
 {
@@ -86,8 +85,10 @@ namespace tremotesf
     private:
         void update(const std::vector<int>& removed, const std::vector<int>& changed, int added);
 
-        std::vector<libtremotesf::Peer> mPeers;
-        libtremotesf::Torrent* mTorrent;
+        // Torrent may be deleted before it is replaced by setTorrent()
+        QPointer<libtremotesf::Torrent> mTorrent;
+        // Peers are stored in torrent, count of rows that the model has reported to views
+        int mPeersCount;
         bool mLoaded;
     signals:
         void loadedChanged();
@@ -18,9 +18,17 @@
 
 #include "servers.h"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
 #include <QFile>
 #include <QDir>
+#include <QSaveFile>
 #include <QSettings>
 #include <QStandardPaths>
 #include <QStringBuilder>
@@ -72,6 +80,13 @@ namespace tremotesf
 
         const QLatin1String localCertificateKey("localCertificate");
 
+        const QLatin1String torrentsSnapshotSuffix(".torrents");
+        const QLatin1String lastTorrentsSuffix(".lasttorrents");
+
+        const quint32 lastTorrentsMagic = 0x544C5354; // "TLST"
+        const quint32 lastTorrentsVersion = 1;
+        const qint64 lastTorrentsHeaderSize = 3 * sizeof(quint32);
+
         Servers* instancePointer = nullptr;
 
         const QLatin1String proxyTypeDefault("Default");
@@ -105,6 +120,70 @@ namespace tremotesf
             return proxyTypeDefault;
         }
 
+        QString serversCacheDirectory()
+        {
+            return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) % QLatin1String("/servers");
+        }
+
+        QString serverCacheFilePath(const QString& serverName, const QLatin1String& suffix)
+        {
+            return serversCacheDirectory() %
+                   QLatin1Char('/') %
+                   QString::fromLatin1(QCryptographicHash::hash(serverName.toUtf8(), QCryptographicHash::Sha1).toHex()) %
+                   suffix;
+        }
+
+        void renameServerCacheFiles(const QString& oldName, const QString& newName)
+        {
+            for (const QLatin1String& suffix : {torrentsSnapshotSuffix, lastTorrentsSuffix}) {
+                const QString newPath(serverCacheFilePath(newName, suffix));
+                QFile::remove(newPath);
+                QFile::rename(serverCacheFilePath(oldName, suffix), newPath);
+            }
+        }
+
+        void removeServerCacheFiles(const QString& name)
+        {
+            for (const QLatin1String& suffix : {torrentsSnapshotSuffix, lastTorrentsSuffix}) {
+                QFile::remove(serverCacheFilePath(name, suffix));
+            }
+        }
+
+        // Layout: header (magic, version, count), sorted binary hashes, finished bitset
+        void writeLastTorrents(const QString& serverName, std::vector<std::pair<libtremotesf::TorrentHash, bool>>& torrents)
+        {
+            std::sort(torrents.begin(), torrents.end(), [](const auto& first, const auto& second) {
+                return std::memcmp(first.first.data(), second.first.data(), LastTorrents::hashSize) < 0;
+            });
+            torrents.erase(std::unique(torrents.begin(), torrents.end(), [](const auto& first, const auto& second) {
+                return std::memcmp(first.first.data(), second.first.data(), LastTorrents::hashSize) == 0;
+            }), torrents.end());
+
+            QDir().mkpath(serversCacheDirectory());
+            QSaveFile file(serverCacheFilePath(serverName, lastTorrentsSuffix));
+            if (!file.open(QIODevice::WriteOnly)) {
+                qWarning() << "Failed to open file" << file.fileName() << file.errorString();
+                return;
+            }
+
+            QDataStream stream(&file);
+            stream << lastTorrentsMagic << lastTorrentsVersion << static_cast<quint32>(torrents.size());
+            for (const auto& torrent : torrents) {
+                stream.writeRawData(torrent.first.data(), LastTorrents::hashSize);
+            }
+            QByteArray finished(static_cast<int>((torrents.size() + 7) / 8), 0);
+            for (size_t i = 0, max = torrents.size(); i < max; ++i) {
+                if (torrents[i].second) {
+                    finished[static_cast<int>(i / 8)] = static_cast<char>(finished[static_cast<int>(i / 8)] | (1 << (i % 8)));
+                }
+            }
+            stream.writeRawData(finished.constData(), finished.size());
+
+            if (!file.commit()) {
+                qWarning() << "Failed to save file" << file.fileName() << file.errorString();
+            }
+        }
+
 #ifdef TREMOTESF_SAILFISHOS
         void migrateFrom0()
         {
@@ -192,7 +271,6 @@ namespace tremotesf
                    int timeout,
 
                    const QVariantMap& mountedDirectories,
-                   const QVariant& lastTorrents,
                    const QVariant& addTorrentDialogDirectories)
         : libtremotesf::Server{name,
                                address,
@@ -219,12 +297,39 @@ namespace tremotesf
                                backgroundUpdateInterval,
                                timeout},
           mountedDirectories(mountedDirectories),
-          lastTorrents(lastTorrents),
           addTorrentDialogDirectories(addTorrentDialogDirectories)
     {
 
     }
 
+    bool LastTorrents::isSaved() const
+    {
+        return mSaved;
+    }
+
+    bool LastTorrents::find(const libtremotesf::TorrentHash& hash, bool& finished) const
+    {
+        if (hash.isNull()) {
+            return false;
+        }
+        int first = 0;
+        int last = mCount;
+        while (first < last) {
+            const int middle = first + (last - first) / 2;
+            const int result = std::memcmp(mHashes + static_cast<size_t>(middle) * hashSize, hash.data(), hashSize);
+            if (result == 0) {
+                finished = (mFinished[middle / 8] & (1 << (middle % 8))) != 0;
+                return true;
+            }
+            if (result < 0) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+        return false;
+    }
+
     Servers* Servers::instance()
     {
         if (!instancePointer) {
@@ -253,6 +358,7 @@ namespace tremotesf
         list.reserve(groups.size());
         for (const QString& group : groups) {
             list.push_back(getServer(group));
+            list.back().originalName = group;
         }
         return list;
     }
@@ -289,15 +395,7 @@ namespace tremotesf
 
     bool Servers::isUnderCurrentServerMountedDirectory(const QString& path) const
     {
-        for (const std::pair<QString, QString>& directory : mCurrentServerMountedDirectories) {
-            const int localSize = directory.first.size();
-            if (path.startsWith(directory.first)) {
-                if (path.size() == localSize || path[localSize] == '/') {
-                    return true;
-                }
-            }
-        }
-        return false;
+        return mLocalToRemoteDirectories.contains(path);
     }
 
     QString Servers::firstLocalDirectory() const
@@ -310,60 +408,109 @@ namespace tremotesf
 
     QString Servers::fromLocalToRemoteDirectory(const QString& path)
     {
-        for (const std::pair<QString, QString>& directory : mCurrentServerMountedDirectories) {
-            const int localSize = directory.first.size();
-            if (path.startsWith(directory.first)) {
-                if (path.size() == localSize || path[localSize] == '/') {
-                    return directory.second % path.midRef(localSize);
-                }
-            }
-        }
-        return QString();
+        return mLocalToRemoteDirectories.map(path);
     }
 
     QString Servers::fromRemoteToLocalDirectory(const QString& path)
     {
-        for (const std::pair<QString, QString>& directory : mCurrentServerMountedDirectories) {
-            const int remoteSize = directory.second.size();
-            if (path.startsWith(directory.second)) {
-                if (path.size() == remoteSize || path[remoteSize] == '/') {
-                    return directory.first % path.midRef(remoteSize);
-                }
-            }
+        return mRemoteToLocalDirectories.map(path);
+    }
+
+    QString Servers::fromRemoteToLocalDirectory(const libtremotesf::InternedString& path)
+    {
+        auto found(mRemoteToLocalInternedDirectories.find(path));
+        if (found == mRemoteToLocalInternedDirectories.end()) {
+            found = mRemoteToLocalInternedDirectories.emplace(path, mRemoteToLocalDirectories.map(path.toString())).first;
         }
-        return QString();
+        return found->second;
     }
 
-    LastTorrents Servers::currentServerLastTorrents() const
+    LastTorrents Servers::lastTorrents(const QString& serverName) const
     {
-        mSettings->beginGroup(currentServerName());
         LastTorrents lastTorrents;
-        const QVariant lastTorrentsVariant(mSettings->value(lastTorrentsKey));
-        if (lastTorrentsVariant.isValid() && lastTorrentsVariant.type() == QVariant::List) {
-            lastTorrents.saved = true;
-            const QVariantList torrentVariants(lastTorrentsVariant.toList());
-            lastTorrents.torrents.reserve(torrentVariants.size());
-            for (const QVariant& variant : torrentVariants) {
-                const QVariantMap torrentMap(variant.toMap());
-                lastTorrents.torrents.push_back({torrentMap[QLatin1String("hashString")].toString(),
-                                                 torrentMap[QLatin1String("finished")].toBool()});
-            }
+
+        auto file(std::make_shared<QFile>(serverCacheFilePath(serverName, lastTorrentsSuffix)));
+        if (!file->open(QIODevice::ReadOnly)) {
+            return lastTorrents;
         }
-        mSettings->endGroup();
+        const qint64 size = file->size();
+        if (size < lastTorrentsHeaderSize) {
+            return lastTorrents;
+        }
+        const uchar* data = file->map(0, size);
+        if (!data) {
+            return lastTorrents;
+        }
+
+        QDataStream header(QByteArray::fromRawData(reinterpret_cast<const char*>(data), lastTorrentsHeaderSize));
+        quint32 magic;
+        quint32 version;
+        quint32 count;
+        header >> magic >> version >> count;
+        if (magic != lastTorrentsMagic ||
+                version != lastTorrentsVersion ||
+                size != lastTorrentsHeaderSize + static_cast<qint64>(count) * LastTorrents::hashSize + (count + 7) / 8) {
+            qWarning() << "Ignoring invalid file" << file->fileName();
+            return lastTorrents;
+        }
+
+        lastTorrents.mSaved = true;
+        lastTorrents.mCount = static_cast<int>(count);
+        lastTorrents.mHashes = reinterpret_cast<const char*>(data + lastTorrentsHeaderSize);
+        lastTorrents.mFinished = data + lastTorrentsHeaderSize + static_cast<qint64>(count) * LastTorrents::hashSize;
+        lastTorrents.mFile = std::move(file);
+
         return lastTorrents;
     }
 
-    void Servers::saveCurrentServerLastTorrents(const libtremotesf::Rpc* rpc)
+    void Servers::saveLastTorrents(const QString& serverName, const libtremotesf::Rpc* rpc) const
     {
-        mSettings->beginGroup(currentServerName());
-        QVariantList torrents;
+        if (serverName.isEmpty()) {
+            return;
+        }
+        std::vector<std::pair<libtremotesf::TorrentHash, bool>> torrents;
         torrents.reserve(rpc->torrents().size());
         for (const auto& torrent : rpc->torrents()) {
-            torrents.push_back(QVariantMap{{QLatin1String("hashString"), torrent->hashString()},
-                                           {QLatin1String("finished"), torrent->isFinished()}});
+            if (!torrent->hash().isNull()) {
+                torrents.emplace_back(torrent->hash(), torrent->isFinished());
+            }
+        }
+        writeLastTorrents(serverName, torrents);
+    }
+
+    void Servers::loadTorrentsSnapshot(const QString& serverName, libtremotesf::Rpc* rpc) const
+    {
+        QFile file(serverCacheFilePath(serverName, torrentsSnapshotSuffix));
+        if (!file.open(QIODevice::ReadOnly)) {
+            return;
+        }
+        const qint64 size = file.size();
+        if (size <= 0 || size > std::numeric_limits<int>::max()) {
+            return;
+        }
+        // Mapping avoids copying the whole file, torrents' data is copied anyway when deserializing
+        uchar* data = file.map(0, size);
+        if (data) {
+            rpc->loadTorrentsSnapshot(QByteArray::fromRawData(reinterpret_cast<const char*>(data), static_cast<int>(size)));
+            file.unmap(data);
+        } else {
+            rpc->loadTorrentsSnapshot(file.readAll());
+        }
+    }
+
+    void Servers::saveTorrentsSnapshot(const QString& serverName, const libtremotesf::Rpc* rpc) const
+    {
+        if (serverName.isEmpty()) {
+            return;
+        }
+        QDir().mkpath(serversCacheDirectory());
+        QSaveFile file(serverCacheFilePath(serverName, torrentsSnapshotSuffix));
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(rpc->saveTorrentsSnapshot());
+            if (!file.commit()) {
+                qWarning() << "Failed to save torrents snapshot:" << file.errorString();
+            }
         }
-        mSettings->setValue(lastTorrentsKey, torrents);
-        mSettings->endGroup();
     }
 
     QStringList Servers::currentServerAddTorrentDialogDirectories() const
@@ -424,6 +571,11 @@ namespace tremotesf
         if (!oldName.isEmpty() && name != oldName) {
             addTorrentDialogDirectories = mSettings->value(oldName % QLatin1Char('/') % addTorrentDialogDirectoriesKey).toStringList();
             mSettings->remove(oldName);
+            renameServerCacheFiles(oldName, name);
+            emit serversRenamed({{oldName, name}});
+        } else if (oldName.isEmpty() && !mSettings->childGroups().contains(name)) {
+            // Stale cache files must not be shown as torrents of a new server
+            removeServerCacheFiles(name);
         }
 
         mSettings->beginGroup(name);
@@ -469,6 +621,7 @@ namespace tremotesf
     void Servers::removeServer(const QString& name)
     {
         mSettings->remove(name);
+        removeServerCacheFiles(name);
         const QStringList Servers(mSettings->childGroups());
         if (Servers.isEmpty()) {
             setCurrentServer(QString());
@@ -481,6 +634,40 @@ namespace tremotesf
     void Servers::saveServers(const std::vector<Server>& servers, const QString& current)
     {
         const bool hadServers = hasServers();
+
+        // Cache files of renamed servers are moved through temporary names since servers may swap names
+        std::vector<std::pair<QString, const Server*>> renamed;
+        for (const Server& server : servers) {
+            if (!server.originalName.isEmpty() && server.originalName != server.name) {
+                // Server names can't end with '/'
+                const QString temporaryName(QString::number(renamed.size()) % QLatin1String("/renamed/"));
+                renameServerCacheFiles(server.originalName, temporaryName);
+                renamed.emplace_back(temporaryName, &server);
+            }
+        }
+        const QStringList oldNames(mSettings->childGroups());
+        for (const QString& name : oldNames) {
+            const bool kept = std::any_of(servers.begin(), servers.end(), [&](const Server& server) {
+                return server.originalName == name;
+            });
+            if (!kept) {
+                removeServerCacheFiles(name);
+            }
+        }
+        for (const Server& server : servers) {
+            if (server.originalName.isEmpty()) {
+                removeServerCacheFiles(server.name);
+            }
+        }
+        QHash<QString, QString> renamedNames;
+        for (const auto& server : renamed) {
+            renameServerCacheFiles(server.first, server.second->name);
+            renamedNames.insert(server.second->originalName, server.second->name);
+        }
+        if (!renamedNames.isEmpty()) {
+            emit serversRenamed(renamedNames);
+        }
+
         mSettings->clear();
         mSettings->setValue(currentServerKey, current);
         for (const Server& server : servers) {
@@ -510,7 +697,6 @@ namespace tremotesf
             mSettings->setValue(backgroundUpdateIntervalKey, server.backgroundUpdateInterval);
             mSettings->setValue(timeoutKey, server.timeout);
             mSettings->setValue(mountedDirectoriesKey, server.mountedDirectories);
-            mSettings->setValue(lastTorrentsKey, server.lastTorrents);
             mSettings->setValue(addTorrentDialogDirectoriesKey, server.addTorrentDialogDirectories);
 
             mSettings->endGroup();
@@ -560,6 +746,20 @@ namespace tremotesf
                 }
                 mSettings->remove(localCertificateKey);
             }
+            if (mSettings->contains(lastTorrentsKey)) {
+                std::vector<std::pair<libtremotesf::TorrentHash, bool>> torrents;
+                const QVariantList torrentVariants(mSettings->value(lastTorrentsKey).toList());
+                torrents.reserve(static_cast<size_t>(torrentVariants.size()));
+                for (const QVariant& variant : torrentVariants) {
+                    const QVariantMap torrentMap(variant.toMap());
+                    const auto hash(libtremotesf::TorrentHash::fromHex(torrentMap[QLatin1String("hashString")].toString()));
+                    if (!hash.isNull()) {
+                        torrents.emplace_back(hash, torrentMap[QLatin1String("finished")].toBool());
+                    }
+                }
+                writeLastTorrents(group, torrents);
+                mSettings->remove(lastTorrentsKey);
+            }
             mSettings->endGroup();
         }
 
@@ -595,7 +795,6 @@ namespace tremotesf
                             mSettings->value(timeoutKey, 30).toInt(),
 
                             mSettings->value(mountedDirectoriesKey).toMap(),
-                            mSettings->value(lastTorrentsKey),
                             mSettings->value(addTorrentDialogDirectoriesKey));
         mSettings->endGroup();
         return server;
@@ -605,8 +804,14 @@ namespace tremotesf
     {
         mCurrentServerMountedDirectories.clear();
         mCurrentServerMountedDirectories.reserve(directories.size());
+        mLocalToRemoteDirectories.clear();
+        mRemoteToLocalDirectories.clear();
+        mRemoteToLocalInternedDirectories.clear();
         for (auto i = directories.cbegin(), end = directories.cend(); i != end; ++i) {
             mCurrentServerMountedDirectories.emplace_back(QDir(i.key()).absolutePath(), QDir(i.value().toString()).absolutePath());
+            const std::pair<QString, QString>& directory = mCurrentServerMountedDirectories.back();
+            mLocalToRemoteDirectories.add(directory.first, directory.second);
+            mRemoteToLocalDirectories.add(directory.second, directory.first);
         }
     }
 
@@ -19,13 +19,21 @@
 #ifndef TREMOTESF_SERVERS_H
 #define TREMOTESF_SERVERS_H
 
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 
+#include <QHash>
 #include <QObject>
 
+#include "libtremotesf/internedstring.h"
 #include "libtremotesf/rpc.h"
+#include "libtremotesf/torrenthash.h"
 
+#include "directorytrie.h"
+
+class QFile;
 class QSettings;
 
 namespace tremotesf
@@ -60,24 +68,36 @@ namespace tremotesf
                int timeout,
 
                const QVariantMap& mountedDirectories,
-               const QVariant& lastTorrents,
                const QVariant& addTorrentDialogDirectories);
 
         QVariantMap mountedDirectories;
-        QVariant lastTorrents;
         QVariant addTorrentDialogDirectories;
+
+        // Name under which server was loaded from settings, empty for new servers.
+        // Used to find cache files of renamed servers when saving
+        QString originalName;
     };
 
-    struct LastTorrents
+    class LastTorrents
     {
-        struct Torrent
-        {
-            QString hashString;
-            bool finished;
-        };
-
-        bool saved = false;
-        std::vector<Torrent> torrents;
+    public:
+        // BitTorrent v2 hashes are truncated, like in tracker and DHT protocols
+        static const int hashSize = libtremotesf::TorrentHash::v1Size;
+
+        bool isSaved() const;
+
+        // Binary search in sorted hashes, returns false if torrent was not saved
+        bool find(const libtremotesf::TorrentHash& hash, bool& finished) const;
+
+    private:
+        friend class Servers;
+
+        bool mSaved = false;
+        int mCount = 0;
+        // Points to memory-mapped file
+        const char* mHashes = nullptr;
+        const uchar* mFinished = nullptr;
+        std::shared_ptr<QFile> mFile;
     };
 
     class Servers : public QObject
@@ -107,9 +127,14 @@ namespace tremotesf
         QString firstLocalDirectory() const;
         Q_INVOKABLE QString fromLocalToRemoteDirectory(const QString& path);
         Q_INVOKABLE QString fromRemoteToLocalDirectory(const QString& path);
+        // Result is cached until mounted directories are changed
+        QString fromRemoteToLocalDirectory(const libtremotesf::InternedString& path);
+
+        LastTorrents lastTorrents(const QString& serverName) const;
+        void saveLastTorrents(const QString& serverName, const libtremotesf::Rpc* rpc) const;
 
-        LastTorrents currentServerLastTorrents() const;
-        Q_INVOKABLE void saveCurrentServerLastTorrents(const libtremotesf::Rpc* rpc);
+        void loadTorrentsSnapshot(const QString& serverName, libtremotesf::Rpc* rpc) const;
+        void saveTorrentsSnapshot(const QString& serverName, const libtremotesf::Rpc* rpc) const;
 
         QStringList currentServerAddTorrentDialogDirectories() const;
         void setCurrentServerAddTorrentDialogDirectories(const QStringList& directories);
@@ -153,9 +178,14 @@ namespace tremotesf
 
         QSettings* mSettings;
         std::vector<std::pair<QString, QString>> mCurrentServerMountedDirectories;
+        DirectoryTrie mLocalToRemoteDirectories;
+        DirectoryTrie mRemoteToLocalDirectories;
+        std::unordered_map<libtremotesf::InternedString, QString> mRemoteToLocalInternedDirectories;
     signals:
         void currentServerChanged();
         void hasServersChanged();
+        // Keys are old names, values are new names
+        void serversRenamed(const QHash<QString, QString>& names);
     };
 }
 
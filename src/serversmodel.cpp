@@ -247,7 +247,6 @@ namespace tremotesf
                                   timeout,
 
                                   mountedDirectories,
-                                  QVariant(),
                                   QVariant());
             endInsertRows();
             if (row == 0) {
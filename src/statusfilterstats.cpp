@@ -18,19 +18,26 @@
 
 #include "statusfilterstats.h"
 
-#include "torrentsproxymodel.h"
+#include "libtremotesf/stdutils.h"
 #include "trpc.h"
 
 namespace tremotesf
 {
+    namespace
+    {
+        const quint64 statsFields = libtremotesf::TorrentData::StatusChanged |
+                                    libtremotesf::TorrentData::DownloadSpeedChanged |
+                                    libtremotesf::TorrentData::UploadSpeedChanged |
+                                    libtremotesf::TorrentData::SizeWhenDoneChanged;
+    }
+
     StatusFilterStats::StatusFilterStats(Rpc* rpc, QObject* parent)
         : QObject(parent),
-          mActiveTorrents(0),
-          mDownloadingTorrents(0),
-          mSeedingTorrents(0),
-          mPausedTorrents(0),
-          mCheckingTorrents(0),
-          mErroredTorrents(0)
+          mRpc(nullptr),
+          mTorrentsCounts(),
+          mDownloadSpeed(0),
+          mUploadSpeed(0),
+          mSizeWhenDone(0)
     {
         setRpc(rpc);
     }
@@ -42,70 +49,113 @@ namespace tremotesf
 
     void StatusFilterStats::setRpc(Rpc* rpc)
     {
-        if (rpc) {
+        if (rpc && !mRpc) {
             mRpc = rpc;
-            QObject::connect(mRpc, &Rpc::torrentsUpdated, this, [=]() {
-                mActiveTorrents = 0;
-                mDownloadingTorrents = 0;
-                mSeedingTorrents = 0;
-                mPausedTorrents = 0;
-                mCheckingTorrents = 0;
-                mErroredTorrents = 0;
-
-                for (const std::shared_ptr<libtremotesf::Torrent>& torrent : mRpc->torrents()) {
-                    const libtremotesf::Torrent* torrentPointer = torrent.get();
-                    if (TorrentsProxyModel::statusFilterAcceptsTorrent(torrentPointer, TorrentsProxyModel::Active)) {
-                        ++mActiveTorrents;
-                    }
-                    if (TorrentsProxyModel::statusFilterAcceptsTorrent(torrentPointer, TorrentsProxyModel::Downloading)) {
-                        ++mDownloadingTorrents;
-                    }
-                    if (TorrentsProxyModel::statusFilterAcceptsTorrent(torrentPointer, TorrentsProxyModel::Seeding)) {
-                        ++mSeedingTorrents;
-                    }
-                    if (TorrentsProxyModel::statusFilterAcceptsTorrent(torrentPointer, TorrentsProxyModel::Paused)) {
-                        ++mPausedTorrents;
-                    }
-                    if (TorrentsProxyModel::statusFilterAcceptsTorrent(torrentPointer, TorrentsProxyModel::Checking)) {
-                        ++mCheckingTorrents;
-                    }
-                    if (TorrentsProxyModel::statusFilterAcceptsTorrent(torrentPointer, TorrentsProxyModel::Errored)) {
-                        ++mErroredTorrents;
-                    }
-                }
-
-                emit updated();
-            });
+            update({}, {}, {}, static_cast<int>(mRpc->torrents().size()));
+            QObject::connect(mRpc, &Rpc::torrentsUpdated, this, &StatusFilterStats::update);
         }
     }
 
+    int StatusFilterStats::torrents(TorrentsProxyModel::StatusFilter filter) const
+    {
+        return mTorrentsCounts[static_cast<size_t>(filter)];
+    }
+
     int StatusFilterStats::activeTorrents() const
     {
-        return mActiveTorrents;
+        return torrents(TorrentsProxyModel::Active);
     }
 
     int StatusFilterStats::downloadingTorrents() const
     {
-        return mDownloadingTorrents;
+        return torrents(TorrentsProxyModel::Downloading);
     }
 
     int StatusFilterStats::seedingTorrents() const
     {
-        return mSeedingTorrents;
+        return torrents(TorrentsProxyModel::Seeding);
     }
 
     int StatusFilterStats::pausedTorrents() const
     {
-        return mPausedTorrents;
+        return torrents(TorrentsProxyModel::Paused);
     }
 
     int StatusFilterStats::checkingTorrents() const
     {
-        return mCheckingTorrents;
+        return torrents(TorrentsProxyModel::Checking);
     }
 
     int StatusFilterStats::erroredTorrents() const
     {
-        return mErroredTorrents;
+        return torrents(TorrentsProxyModel::Errored);
+    }
+
+    long long StatusFilterStats::downloadSpeed() const
+    {
+        return mDownloadSpeed;
+    }
+
+    long long StatusFilterStats::uploadSpeed() const
+    {
+        return mUploadSpeed;
+    }
+
+    long long StatusFilterStats::sizeWhenDone() const
+    {
+        return mSizeWhenDone;
+    }
+
+    void StatusFilterStats::update(const std::vector<int>& removed, const std::vector<int>& changed, const std::vector<quint64>& changedFields, int added)
+    {
+        if (!removed.empty()) {
+            VectorBatchRemover<TorrentStats> remover(mTorrents);
+            for (int index : removed) {
+                addTorrent(mTorrents[static_cast<size_t>(index)], -1);
+                remover.remove(index);
+            }
+            remover.doRemove();
+        }
+
+        for (size_t i = 0, max = changed.size(); i < max; ++i) {
+            if (changedFields[i] & statsFields) {
+                const auto row = static_cast<size_t>(changed[i]);
+                TorrentStats& stats = mTorrents[row];
+                addTorrent(stats, -1);
+                stats = torrentStats(row);
+                addTorrent(stats, 1);
+            }
+        }
+
+        if (added > 0) {
+            mTorrents.reserve(mTorrents.size() + static_cast<size_t>(added));
+            for (size_t row = mTorrents.size(), max = row + static_cast<size_t>(added); row < max; ++row) {
+                mTorrents.push_back(torrentStats(row));
+                addTorrent(mTorrents.back(), 1);
+            }
+        }
+
+        emit updated();
+    }
+
+    void StatusFilterStats::addTorrent(const TorrentStats& stats, int sign)
+    {
+        for (int filter = TorrentsProxyModel::All; filter < TorrentsProxyModel::StatusFilterCount; ++filter) {
+            if (TorrentsProxyModel::statusFilterAcceptsStatus(stats.status, static_cast<TorrentsProxyModel::StatusFilter>(filter))) {
+                mTorrentsCounts[static_cast<size_t>(filter)] += sign;
+            }
+        }
+        mDownloadSpeed += sign * stats.downloadSpeed;
+        mUploadSpeed += sign * stats.uploadSpeed;
+        mSizeWhenDone += sign * stats.sizeWhenDone;
+    }
+
+    StatusFilterStats::TorrentStats StatusFilterStats::torrentStats(size_t row) const
+    {
+        const libtremotesf::TorrentsColumns& columns = mRpc->torrentsColumns();
+        return {columns.status[row],
+                columns.downloadSpeed[row],
+                columns.uploadSpeed[row],
+                columns.sizeWhenDone[row]};
     }
 }
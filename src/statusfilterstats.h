@@ -19,12 +19,13 @@
 #ifndef TREMOTESF_STATUSFILTERSTATS_H
 #define TREMOTESF_STATUSFILTERSTATS_H
 
+#include <array>
+#include <vector>
+
 #include <QObject>
 
-namespace libtremotesf
-{
-    class Torrent;
-}
+#include "libtremotesf/torrent.h"
+#include "torrentsproxymodel.h"
 
 namespace tremotesf
 {
@@ -40,12 +41,17 @@ namespace tremotesf
         Q_PROPERTY(int pausedTorrents READ pausedTorrents NOTIFY updated)
         Q_PROPERTY(int checkingTorrents READ checkingTorrents NOTIFY updated)
         Q_PROPERTY(int erroredTorrents READ erroredTorrents NOTIFY updated)
+        Q_PROPERTY(long long downloadSpeed READ downloadSpeed NOTIFY updated)
+        Q_PROPERTY(long long uploadSpeed READ uploadSpeed NOTIFY updated)
+        Q_PROPERTY(long long sizeWhenDone READ sizeWhenDone NOTIFY updated)
     public:
         explicit StatusFilterStats(Rpc* rpc = nullptr, QObject* parent = nullptr);
 
         Rpc* rpc() const;
         void setRpc(Rpc* rpc);
 
+        Q_INVOKABLE int torrents(tremotesf::TorrentsProxyModel::StatusFilter filter) const;
+
         int activeTorrents() const;
         int downloadingTorrents() const;
         int seedingTorrents() const;
@@ -53,14 +59,33 @@ namespace tremotesf
         int checkingTorrents() const;
         int erroredTorrents() const;
 
+        // Sums over all torrents
+        long long downloadSpeed() const;
+        long long uploadSpeed() const;
+        long long sizeWhenDone() const;
+
     private:
+        struct TorrentStats
+        {
+            libtremotesf::TorrentData::Status status;
+            long long downloadSpeed;
+            long long uploadSpeed;
+            long long sizeWhenDone;
+        };
+
+        void update(const std::vector<int>& removed, const std::vector<int>& changed, const std::vector<quint64>& changedFields, int added);
+        void addTorrent(const TorrentStats& stats, int sign);
+        TorrentStats torrentStats(size_t row) const;
+
         Rpc* mRpc;
-        int mActiveTorrents;
-        int mDownloadingTorrents;
-        int mSeedingTorrents;
-        int mPausedTorrents;
-        int mCheckingTorrents;
-        int mErroredTorrents;
+
+        // Values that were used to compute counters, rows match Rpc::torrents()
+        std::vector<TorrentStats> mTorrents;
+
+        std::array<int, TorrentsProxyModel::StatusFilterCount> mTorrentsCounts;
+        long long mDownloadSpeed;
+        long long mUploadSpeed;
+        long long mSizeWhenDone;
     signals:
         void updated();
     };
@@ -0,0 +1,170 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "torrentsgroups.h"
+
+#include <algorithm>
+
+#include "libtremotesf/rpc.h"
+#include "libtremotesf/stdutils.h"
+#include "libtremotesf/torrent.h"
+
+namespace tremotesf
+{
+    using libtremotesf::InternedString;
+    using libtremotesf::TorrentData;
+
+    namespace
+    {
+        const quint64 statsFields = TorrentData::DownloadSpeedChanged |
+                                    TorrentData::UploadSpeedChanged |
+                                    TorrentData::SizeWhenDoneChanged;
+
+        bool compareIds(const InternedString& first, const InternedString& second)
+        {
+            return first.id() < second.id();
+        }
+    }
+
+    TorrentsGroups::TorrentsGroups(GroupsGetter groupsGetter, quint64 groupsFields)
+        : mGroupsGetter(std::move(groupsGetter)),
+          mGroupsFields(groupsFields)
+    {
+
+    }
+
+    const std::vector<InternedString>& TorrentsGroups::update(const libtremotesf::Rpc* rpc,
+                                                       const std::vector<int>& removed,
+                                                       const std::vector<int>& changed,
+                                                       const std::vector<quint64>& changedFields,
+                                                       int added)
+    {
+        mChangedGroups.clear();
+
+        if (!removed.empty()) {
+            VectorBatchRemover<TorrentItem> remover(mTorrents);
+            for (int index : removed) {
+                addTorrent(mTorrents[static_cast<size_t>(index)], false);
+                remover.remove(index);
+            }
+            remover.doRemove();
+        }
+
+        for (size_t i = 0, max = changed.size(); i < max; ++i) {
+            const quint64 fields = changedFields[i];
+            if (fields & (mGroupsFields | statsFields)) {
+                const auto row = static_cast<size_t>(changed[i]);
+                TorrentItem& torrent = mTorrents[row];
+                addTorrent(torrent, false);
+                if (fields & mGroupsFields) {
+                    setTorrentGroups(torrent, rpc, row);
+                }
+                setTorrentStats(torrent, rpc, row);
+                addTorrent(torrent, true);
+            }
+        }
+
+        if (added > 0) {
+            mTorrents.reserve(mTorrents.size() + static_cast<size_t>(added));
+            for (size_t row = mTorrents.size(), max = row + static_cast<size_t>(added); row < max; ++row) {
+                mTorrents.emplace_back();
+                TorrentItem& torrent = mTorrents.back();
+                setTorrentGroups(torrent, rpc, row);
+                setTorrentStats(torrent, rpc, row);
+                addTorrent(torrent, true);
+            }
+        }
+
+        std::sort(mChangedGroups.begin(), mChangedGroups.end(), compareIds);
+        mChangedGroups.erase(std::unique(mChangedGroups.begin(), mChangedGroups.end()), mChangedGroups.end());
+
+        for (const InternedString& name : mChangedGroups) {
+            const auto found(mGroups.find(name));
+            if (found != mGroups.end() && found->second.torrents == 0) {
+                mGroups.erase(found);
+            }
+        }
+
+        return mChangedGroups;
+    }
+
+    const TorrentsGroups::Group* TorrentsGroups::group(const InternedString& name) const
+    {
+        const auto found(mGroups.find(name));
+        if (found == mGroups.end()) {
+            return nullptr;
+        }
+        return &found->second;
+    }
+
+    bool TorrentsGroups::hasTorrent(const InternedString& name, int row) const
+    {
+        const auto index = static_cast<size_t>(row);
+        if (index >= mTorrents.size()) {
+            return false;
+        }
+        const std::vector<InternedString>& groups = mTorrents[index].groups;
+        return std::binary_search(groups.begin(), groups.end(), name, compareIds);
+    }
+
+    std::vector<InternedString> TorrentsGroups::groups() const
+    {
+        std::vector<InternedString> groups;
+        groups.reserve(mGroups.size());
+        for (const auto& i : mGroups) {
+            groups.push_back(i.first);
+        }
+        return groups;
+    }
+
+    const std::vector<InternedString>& TorrentsGroups::changedGroups() const
+    {
+        return mChangedGroups;
+    }
+
+    void TorrentsGroups::addTorrent(const TorrentItem& torrent, bool add)
+    {
+        const int sign = add ? 1 : -1;
+        for (const InternedString& name : torrent.groups) {
+            Group& group = mGroups[name];
+            group.torrents += sign;
+            group.downloadSpeed += sign * torrent.downloadSpeed;
+            group.uploadSpeed += sign * torrent.uploadSpeed;
+            group.sizeWhenDone += sign * torrent.sizeWhenDone;
+            mChangedGroups.push_back(name);
+        }
+    }
+
+    void TorrentsGroups::setTorrentStats(TorrentItem& torrent, const libtremotesf::Rpc* rpc, size_t row) const
+    {
+        const libtremotesf::TorrentsColumns& columns = rpc->torrentsColumns();
+        torrent.downloadSpeed = columns.downloadSpeed[row];
+        torrent.uploadSpeed = columns.uploadSpeed[row];
+        torrent.sizeWhenDone = columns.sizeWhenDone[row];
+    }
+
+    void TorrentsGroups::setTorrentGroups(TorrentItem& torrent, const libtremotesf::Rpc* rpc, size_t row) const
+    {
+        torrent.groups.clear();
+        mGroupsGetter(rpc->torrents()[row].get(), torrent.groups);
+        // Torrent is counted once in each group
+        std::sort(torrent.groups.begin(), torrent.groups.end(), compareIds);
+        torrent.groups.erase(std::unique(torrent.groups.begin(), torrent.groups.end()), torrent.groups.end());
+    }
+}
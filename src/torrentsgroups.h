@@ -0,0 +1,93 @@
+/*
+ * Tremotesf
+ * Copyright (C) 2015-2018 Alexey Rochev <equeim@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TREMOTESF_TORRENTSGROUPS_H
+#define TREMOTESF_TORRENTSGROUPS_H
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "libtremotesf/internedstring.h"
+
+namespace libtremotesf
+{
+    class Rpc;
+    class Torrent;
+}
+
+namespace tremotesf
+{
+    // Groups torrents by tracker sites or download directories,
+    // updated incrementally from Rpc::torrentsUpdated() arguments
+    class TorrentsGroups
+    {
+    public:
+        struct Group
+        {
+            int torrents = 0;
+            long long downloadSpeed = 0;
+            long long uploadSpeed = 0;
+            long long sizeWhenDone = 0;
+        };
+
+        using GroupsGetter = std::function<void(const libtremotesf::Torrent* torrent, std::vector<libtremotesf::InternedString>& groups)>;
+
+        // groupsFields are TorrentData::ChangedField flags of fields that groupsGetter depends on
+        explicit TorrentsGroups(GroupsGetter groupsGetter, quint64 groupsFields);
+
+        // Returns groups that were added, changed or removed
+        const std::vector<libtremotesf::InternedString>& update(const libtremotesf::Rpc* rpc,
+                                                         const std::vector<int>& removed,
+                                                         const std::vector<int>& changed,
+                                                         const std::vector<quint64>& changedFields,
+                                                         int added);
+        // Returns nullptr if group doesn't have torrents
+        const Group* group(const libtremotesf::InternedString& name) const;
+        bool hasTorrent(const libtremotesf::InternedString& name, int row) const;
+
+        std::vector<libtremotesf::InternedString> groups() const;
+        // Groups that were affected by last update()
+        const std::vector<libtremotesf::InternedString>& changedGroups() const;
+
+    private:
+        struct TorrentItem
+        {
+            // Sorted by id
+            std::vector<libtremotesf::InternedString> groups;
+            long long downloadSpeed;
+            long long uploadSpeed;
+            long long sizeWhenDone;
+        };
+
+        void addTorrent(const TorrentItem& torrent, bool add);
+        void setTorrentStats(TorrentItem& torrent, const libtremotesf::Rpc* rpc, size_t row) const;
+        void setTorrentGroups(TorrentItem& torrent, const libtremotesf::Rpc* rpc, size_t row) const;
+
+        const GroupsGetter mGroupsGetter;
+        const quint64 mGroupsFields;
+
+        // Rows match Rpc::torrents()
+        std::vector<TorrentItem> mTorrents;
+        std::unordered_map<libtremotesf::InternedString, Group> mGroups;
+        std::vector<libtremotesf::InternedString> mChangedGroups;
+    };
+}
+
+#endif // TREMOTESF_TORRENTSGROUPS_H
@@ -18,8 +18,10 @@
 
 #include "torrentsmodel.h"
 
+#include <algorithm>
+
 #include <QCoreApplication>
-#include <QPixmap>
+#include <QIcon>
 
 #include "libtremotesf/stdutils.h"
 #include "libtremotesf/torrent.h"
@@ -33,9 +35,150 @@ namespace tremotesf
     using libtremotesf::Torrent;
     using libtremotesf::TorrentData;
 
+    namespace
+    {
+#ifdef TREMOTESF_SAILFISHOS
+        struct RoleFields
+        {
+            int role;
+            quint64 fields;
+        };
+
+        const RoleFields rolesFields[] = {
+            {TorrentsModel::NameRole, TorrentData::NameChanged},
+            {TorrentsModel::StatusRole, TorrentData::StatusChanged},
+            {TorrentsModel::TotalSizeRole, TorrentData::TotalSizeChanged},
+            {TorrentsModel::PercentDoneRole, TorrentData::PercentDoneChanged},
+            {TorrentsModel::EtaRole, TorrentData::EtaChanged},
+            {TorrentsModel::RatioRole, TorrentData::RatioChanged},
+            {TorrentsModel::AddedDateRole, TorrentData::AddedDateChanged}
+        };
+#else
+        // Indexed by TorrentsModel::Column
+        const quint64 columnsFields[] = {
+            // NameColumn, status icon
+            TorrentData::NameChanged | TorrentData::StatusChanged,
+            // SizeWhenDoneColumn
+            TorrentData::SizeWhenDoneChanged,
+            // TotalSizeColumn
+            TorrentData::TotalSizeChanged | TorrentData::SizeWhenDoneChanged,
+            // ProgressBarColumn
+            TorrentData::PercentDoneChanged | TorrentData::RecheckProgressChanged | TorrentData::StatusChanged,
+            // ProgressColumn
+            TorrentData::PercentDoneChanged | TorrentData::RecheckProgressChanged | TorrentData::StatusChanged,
+            // StatusColumn
+            TorrentData::StatusChanged | TorrentData::ErrorStringChanged,
+            // PriorityColumn
+            TorrentData::BandwidthPriorityChanged,
+            // QueuePositionColumn
+            TorrentData::QueuePositionChanged,
+            // SeedersColumn
+            TorrentData::SeedersChanged,
+            // LeechersColumn
+            TorrentData::LeechersChanged,
+            // DownloadSpeedColumn
+            TorrentData::DownloadSpeedChanged,
+            // UploadSpeedColumn
+            TorrentData::UploadSpeedChanged,
+            // EtaColumn
+            TorrentData::EtaChanged,
+            // RatioColumn
+            TorrentData::RatioChanged,
+            // AddedDateColumn
+            TorrentData::AddedDateChanged,
+            // DoneDateColumn
+            TorrentData::DoneDateChanged,
+            // DownloadSpeedLimitColumn
+            TorrentData::DownloadSpeedLimitedChanged | TorrentData::DownloadSpeedLimitChanged,
+            // UploadSpeedLimitColumn
+            TorrentData::UploadSpeedLimitedChanged | TorrentData::UploadSpeedLimitChanged,
+            // TotalDownloadedColumn
+            TorrentData::TotalDownloadedChanged,
+            // TotalUploadedColumn
+            TorrentData::TotalUploadedChanged,
+            // LeftUntilDoneColumn
+            TorrentData::LeftUntilDoneChanged,
+            // DownloadDirectoryColumn
+            TorrentData::DownloadDirectoryChanged,
+            // CompletedSizeColumn
+            TorrentData::CompletedSizeChanged,
+            // ActivityDateColumn
+            TorrentData::ActivityDateChanged
+        };
+        static_assert(sizeof(columnsFields) / sizeof(quint64) == TorrentsModel::ColumnCount, "columnsFields must have entry for each column");
+
+        QString formatDisplayString(const Torrent* torrent, int column)
+        {
+            switch (column) {
+            case TorrentsModel::SizeWhenDoneColumn:
+                return Utils::formatByteSize(torrent->sizeWhenDone());
+            case TorrentsModel::TotalSizeColumn:
+                return Utils::formatByteSize(torrent->sizeWhenDone());
+            case TorrentsModel::ProgressColumn:
+                if (torrent->status() == TorrentData::Checking) {
+                    return Utils::formatProgress(torrent->recheckProgress());
+                }
+                return Utils::formatProgress(torrent->percentDone());
+            case TorrentsModel::StatusColumn:
+                switch (torrent->status()) {
+                case TorrentData::Paused:
+                    return qApp->translate("tremotesf", "Paused", "Torrent status");
+                case TorrentData::Downloading:
+                case TorrentData::StalledDownloading:
+                    return qApp->translate("tremotesf", "Downloading", "Torrent status");
+                case TorrentData::Seeding:
+                case TorrentData::StalledSeeding:
+                    return qApp->translate("tremotesf", "Seeding", "Torrent status");
+                case TorrentData::QueuedForDownloading:
+                case TorrentData::QueuedForSeeding:
+                    return qApp->translate("tremotesf", "Queued", "Torrent status");
+                case TorrentData::Checking:
+                    return qApp->translate("tremotesf", "Checking", "Torrent status");
+                case TorrentData::QueuedForChecking:
+                    return qApp->translate("tremotesf", "Queued for checking");
+                case TorrentData::Errored:
+                    return torrent->errorString();
+                }
+                break;
+            case TorrentsModel::DownloadSpeedColumn:
+                return Utils::formatByteSpeed(torrent->downloadSpeed());
+            case TorrentsModel::UploadSpeedColumn:
+                return Utils::formatByteSpeed(torrent->uploadSpeed());
+            case TorrentsModel::EtaColumn:
+                return Utils::formatEta(torrent->eta());
+            case TorrentsModel::RatioColumn:
+                return Utils::formatRatio(torrent->ratio());
+            case TorrentsModel::DownloadSpeedLimitColumn:
+                if (torrent->isDownloadSpeedLimited()) {
+                    return Utils::formatSpeedLimit(torrent->downloadSpeedLimit());
+                }
+                break;
+            case TorrentsModel::UploadSpeedLimitColumn:
+                if (torrent->isUploadSpeedLimited()) {
+                    return Utils::formatSpeedLimit(torrent->uploadSpeedLimit());
+                }
+                break;
+            case TorrentsModel::TotalDownloadedColumn:
+                return Utils::formatByteSize(torrent->totalDownloaded());
+            case TorrentsModel::TotalUploadedColumn:
+                return Utils::formatByteSize(torrent->totalUploaded());
+            case TorrentsModel::LeftUntilDoneColumn:
+                return Utils::formatByteSize(torrent->leftUntilDone());
+            case TorrentsModel::CompletedSizeColumn:
+                return Utils::formatByteSize(torrent->completedSize());
+            }
+            return QString();
+        }
+#endif
+    }
+
     TorrentsModel::TorrentsModel(Rpc* rpc, QObject* parent)
         : QAbstractTableModel(parent),
-          mRpc(nullptr)
+          mRpc(nullptr),
+          mChangingFields(TorrentData::AllChanged),
+          mChangingRows(nullptr),
+          mChangingRowsFields(nullptr),
+          mUpdatesSuspended(false)
     {
         setRpc(rpc);
     }
@@ -76,23 +219,23 @@ namespace tremotesf
             if (index.column() == NameColumn) {
                 switch (torrent->status()) {
                 case TorrentData::Paused:
-                    return QPixmap(Utils::statusIconPath(Utils::PausedIcon));
+                    return Utils::statusIcon(Utils::PausedIcon);
                 case TorrentData::Seeding:
-                    return QPixmap(Utils::statusIconPath(Utils::SeedingIcon));
+                    return Utils::statusIcon(Utils::SeedingIcon);
                 case TorrentData::Downloading:
-                    return QPixmap(Utils::statusIconPath(Utils::DownloadingIcon));
+                    return Utils::statusIcon(Utils::DownloadingIcon);
                 case TorrentData::StalledDownloading:
-                    return QPixmap(Utils::statusIconPath(Utils::StalledDownloadingIcon));
+                    return Utils::statusIcon(Utils::StalledDownloadingIcon);
                 case TorrentData::StalledSeeding:
-                    return QPixmap(Utils::statusIconPath(Utils::StalledSeedingIcon));
+                    return Utils::statusIcon(Utils::StalledSeedingIcon);
                 case TorrentData::QueuedForDownloading:
                 case TorrentData::QueuedForSeeding:
-                    return QPixmap(Utils::statusIconPath(Utils::QueuedIcon));
+                    return Utils::statusIcon(Utils::QueuedIcon);
                 case TorrentData::Checking:
                 case TorrentData::QueuedForChecking:
-                    return QPixmap(Utils::statusIconPath(Utils::CheckingIcon));
+                    return Utils::statusIcon(Utils::CheckingIcon);
                 case TorrentData::Errored:
-                    return QPixmap(Utils::statusIconPath(Utils::ErroredIcon));
+                    return Utils::statusIcon(Utils::ErroredIcon);
                 }
             }
             break;
@@ -101,73 +244,32 @@ namespace tremotesf
             case NameColumn:
                 return torrent->name();
             case SizeWhenDoneColumn:
-                return Utils::formatByteSize(torrent->sizeWhenDone());
             case TotalSizeColumn:
-                return Utils::formatByteSize(torrent->sizeWhenDone());
             case ProgressColumn:
-                if (torrent->status() == TorrentData::Checking) {
-                    return Utils::formatProgress(torrent->recheckProgress());
-                }
-                return Utils::formatProgress(torrent->percentDone());
             case StatusColumn:
-                switch (torrent->status()) {
-                case TorrentData::Paused:
-                    return qApp->translate("tremotesf", "Paused", "Torrent status");
-                case TorrentData::Downloading:
-                case TorrentData::StalledDownloading:
-                    return qApp->translate("tremotesf", "Downloading", "Torrent status");
-                case TorrentData::Seeding:
-                case TorrentData::StalledSeeding:
-                    return qApp->translate("tremotesf", "Seeding", "Torrent status");
-                case TorrentData::QueuedForDownloading:
-                case TorrentData::QueuedForSeeding:
-                    return qApp->translate("tremotesf", "Queued", "Torrent status");
-                case TorrentData::Checking:
-                    return qApp->translate("tremotesf", "Checking", "Torrent status");
-                case TorrentData::QueuedForChecking:
-                    return qApp->translate("tremotesf", "Queued for checking");
-                case TorrentData::Errored:
-                    return torrent->errorString();
-                }
-                break;
+            case DownloadSpeedColumn:
+            case UploadSpeedColumn:
+            case EtaColumn:
+            case RatioColumn:
+            case DownloadSpeedLimitColumn:
+            case UploadSpeedLimitColumn:
+            case TotalDownloadedColumn:
+            case TotalUploadedColumn:
+            case LeftUntilDoneColumn:
+            case CompletedSizeColumn:
+                return displayString(index.row(), index.column());
             case QueuePositionColumn:
                 return torrent->queuePosition();
             case SeedersColumn:
                 return torrent->seeders();
             case LeechersColumn:
                 return torrent->leechers();
-            case DownloadSpeedColumn:
-                return Utils::formatByteSpeed(torrent->downloadSpeed());
-            case UploadSpeedColumn:
-                return Utils::formatByteSpeed(torrent->uploadSpeed());
-            case EtaColumn:
-                return Utils::formatEta(torrent->eta());
-            case RatioColumn:
-                return Utils::formatRatio(torrent->ratio());
             case AddedDateColumn:
                 return torrent->addedDate();
             case DoneDateColumn:
                 return torrent->doneDate();
-            case DownloadSpeedLimitColumn:
-                if (torrent->isDownloadSpeedLimited()) {
-                    return Utils::formatSpeedLimit(torrent->downloadSpeedLimit());
-                }
-                break;
-            case UploadSpeedLimitColumn:
-                if (torrent->isUploadSpeedLimited()) {
-                    return Utils::formatSpeedLimit(torrent->uploadSpeedLimit());
-                }
-                break;
-            case TotalDownloadedColumn:
-                return Utils::formatByteSize(torrent->totalDownloaded());
-            case TotalUploadedColumn:
-                return Utils::formatByteSize(torrent->totalUploaded());
-            case LeftUntilDoneColumn:
-                return Utils::formatByteSize(torrent->leftUntilDone());
             case DownloadDirectoryColumn:
                 return torrent->downloadDirectory();
-            case CompletedSizeColumn:
-                return Utils::formatByteSize(torrent->completedSize());
             case ActivityDateColumn:
                 return torrent->activityDate();
             }
@@ -195,9 +297,9 @@ namespace tremotesf
             case RatioColumn:
                 return torrent->ratio();
             case AddedDateColumn:
-                return torrent->addedDate();
+                return torrent->data().addedDate;
             case DoneDateColumn:
-                return torrent->doneDate();
+                return torrent->data().doneDate;
             case DownloadSpeedLimitColumn:
                 if (torrent->isDownloadSpeedLimited()) {
                     return torrent->downloadSpeedLimit();
@@ -217,7 +319,7 @@ namespace tremotesf
             case CompletedSizeColumn:
                 return torrent->completedSize();
             case ActivityDateColumn:
-                return torrent->activityDate();
+                return torrent->data().activityDate;
             default:
                 return data(index, Qt::DisplayRole);
             }
@@ -301,6 +403,10 @@ namespace tremotesf
         beginRemoveRows(parent, row, row + count - 1);
         const auto first(mTorrents.begin() + row);
         mTorrents.erase(first, first + count);
+#ifndef TREMOTESF_SAILFISHOS
+        const auto firstStrings(mDisplayStrings.begin() + row);
+        mDisplayStrings.erase(firstStrings, firstStrings + count);
+#endif
         endRemoveRows();
         return true;
     }
@@ -314,7 +420,7 @@ namespace tremotesf
     {
         if (rpc && !mRpc) {
             mRpc = rpc;
-            update({}, {}, mRpc->torrents().size());
+            update({}, {}, {}, mRpc->torrents().size());
             QObject::connect(mRpc, &Rpc::torrentsUpdated, this, &TorrentsModel::update);
         }
     }
@@ -339,6 +445,42 @@ namespace tremotesf
         return ids;
     }
 
+    quint64 TorrentsModel::changingFields() const
+    {
+        return mChangingFields;
+    }
+
+    quint64 TorrentsModel::changingFields(int row) const
+    {
+        if (!mChangingRows) {
+            return mChangingFields;
+        }
+        const auto found(std::lower_bound(mChangingRows->begin(), mChangingRows->end(), row));
+        if (found == mChangingRows->end() || *found != row) {
+            return 0;
+        }
+        return (*mChangingRowsFields)[static_cast<size_t>(found - mChangingRows->begin())];
+    }
+
+    bool TorrentsModel::isUpdatesSuspended() const
+    {
+        return mUpdatesSuspended;
+    }
+
+    void TorrentsModel::setUpdatesSuspended(bool suspended)
+    {
+        if (suspended == mUpdatesSuspended) {
+            return;
+        }
+        mUpdatesSuspended = suspended;
+        beginResetModel();
+        clearTorrents();
+        if (!suspended && mRpc) {
+            addTorrents(static_cast<int>(mRpc->torrents().size()));
+        }
+        endResetModel();
+    }
+
 #ifdef TREMOTESF_SAILFISHOS
     QHash<int, QByteArray> TorrentsModel::roleNames() const
     {
@@ -352,8 +494,12 @@ namespace tremotesf
     }
 #endif
 
-    void TorrentsModel::update(const std::vector<int>& removed, const std::vector<int>& changed, int added)
+    void TorrentsModel::update(const std::vector<int>& removed, const std::vector<int>& changed, const std::vector<quint64>& changedFields, int added)
     {
+        if (mUpdatesSuspended) {
+            return;
+        }
+
         if (!removed.empty()) {
             ModelBatchRemover remover{this};
             for (int index : removed) {
@@ -363,35 +509,137 @@ namespace tremotesf
         }
 
         if (!changed.empty()) {
-            ModelBatchChanger changer{this};
-            for (int index : changed) {
-                changer.changed(index);
+#ifndef TREMOTESF_SAILFISHOS
+            for (size_t i = 0, max = changed.size(); i < max; ++i) {
+                invalidateDisplayStrings(changed[i], changedFields[i]);
+            }
+#endif
+            mChangingRows = &changed;
+            mChangingRowsFields = &changedFields;
+            // Emit dataChanged() for each range of consecutive rows, with union of their changed fields
+            size_t first = 0;
+            quint64 fields = changedFields[0];
+            for (size_t i = 1, max = changed.size(); i <= max; ++i) {
+                if (i == max || changed[i] != (changed[i - 1] + 1)) {
+                    emitDataChanged(changed[first], changed[i - 1], fields);
+                    if (i < max) {
+                        first = i;
+                        fields = changedFields[i];
+                    }
+                } else {
+                    fields |= changedFields[i];
+                }
             }
-            changer.changed();
+            mChangingRows = nullptr;
+            mChangingRowsFields = nullptr;
+            emit dataChangedBatchFinished();
         }
 
         if (added > 0) {
             const int first = static_cast<int>(mTorrents.size());
             const int last = first + added - 1;
             beginInsertRows(QModelIndex(), first, last);
-            mTorrents.reserve(static_cast<size_t>(last + 1));
-
-            for (auto end = mRpc->torrents().end(), i = end - added; i != end; ++i) {
-                const auto& torrent = *i;
-                mTorrents.push_back(torrent);
-
-                const Torrent* torrentPointer = torrent.get();
-                QObject::connect(torrentPointer, &Torrent::limitsEdited, this, [=] {
-                    for (int i = 0, max = static_cast<int>(mTorrents.size()); i < max; ++i) {
-                        if (mTorrents[static_cast<size_t>(i)].get() == torrentPointer) {
-                            emit dataChanged(index(i, 0), index(i, columnCount() - 1));
-                            break;
-                        }
+            addTorrents(added);
+            endInsertRows();
+        }
+    }
+
+    void TorrentsModel::addTorrents(int count)
+    {
+        mTorrents.reserve(mTorrents.size() + static_cast<size_t>(count));
+#ifndef TREMOTESF_SAILFISHOS
+        mDisplayStrings.resize(mTorrents.size() + static_cast<size_t>(count));
+#endif
+
+        for (auto end = mRpc->torrents().end(), i = end - count; i != end; ++i) {
+            const auto& torrent = *i;
+            mTorrents.push_back(torrent);
+
+            const Torrent* torrentPointer = torrent.get();
+            QObject::connect(torrentPointer, &Torrent::limitsEdited, this, [=] {
+                for (int i = 0, max = static_cast<int>(mTorrents.size()); i < max; ++i) {
+                    if (mTorrents[static_cast<size_t>(i)].get() == torrentPointer) {
+#ifndef TREMOTESF_SAILFISHOS
+                        invalidateDisplayStrings(i, TorrentData::AllChanged);
+#endif
+                        emit dataChanged(index(i, 0), index(i, columnCount() - 1));
+                        emit dataChangedBatchFinished();
+                        break;
                     }
-                });
+                }
+            });
+        }
+    }
+
+    void TorrentsModel::clearTorrents()
+    {
+        for (const auto& torrent : mTorrents) {
+            QObject::disconnect(torrent.get(), nullptr, this, nullptr);
+        }
+        mTorrents.clear();
+        mTorrents.shrink_to_fit();
+#ifndef TREMOTESF_SAILFISHOS
+        mDisplayStrings.clear();
+        mDisplayStrings.shrink_to_fit();
+#endif
+    }
+
+    void TorrentsModel::emitDataChanged(int firstRow, int lastRow, quint64 fields)
+    {
+        mChangingFields = fields;
+#ifdef TREMOTESF_SAILFISHOS
+        QVector<int> roles;
+        for (const RoleFields& roleFields : rolesFields) {
+            if (roleFields.fields & fields) {
+                roles.push_back(roleFields.role);
+            }
+        }
+        if (!roles.isEmpty()) {
+            emit dataChanged(index(firstRow, 0), index(lastRow, 0), roles);
+        }
+#else
+        QVector<int> roles{Qt::DisplayRole, SortRole};
+        if (fields & TorrentData::StatusChanged) {
+            roles.push_back(Qt::DecorationRole);
+        }
+        // Emit dataChanged() for each range of consecutive changed columns
+        int firstColumn = -1;
+        for (int column = 0; column <= ColumnCount; ++column) {
+            const bool columnChanged = (column < ColumnCount) && (columnsFields[column] & fields);
+            if (columnChanged) {
+                if (firstColumn == -1) {
+                    firstColumn = column;
+                }
+            } else if (firstColumn != -1) {
+                emit dataChanged(index(firstRow, firstColumn), index(lastRow, column - 1), roles);
+                firstColumn = -1;
             }
+        }
+#endif
+        mChangingFields = TorrentData::AllChanged;
+    }
 
-            endInsertRows();
+#ifndef TREMOTESF_SAILFISHOS
+    const QString& TorrentsModel::displayString(int row, int column) const
+    {
+        DisplayStrings& strings = mDisplayStrings[static_cast<size_t>(row)];
+        QString& string = strings.strings[static_cast<size_t>(column)];
+        const quint32 bit = quint32(1) << column;
+        if (!(strings.valid & bit)) {
+            string = formatDisplayString(mTorrents[static_cast<size_t>(row)].get(), column);
+            strings.valid |= bit;
         }
+        return string;
     }
+
+    void TorrentsModel::invalidateDisplayStrings(int row, quint64 fields)
+    {
+        DisplayStrings& strings = mDisplayStrings[static_cast<size_t>(row)];
+        for (int column = 0; column < ColumnCount; ++column) {
+            if (columnsFields[column] & fields) {
+                strings.valid &= ~(quint32(1) << column);
+            }
+        }
+    }
+#endif
 }
@@ -19,6 +19,9 @@
 #ifndef TREMOTESF_TORRENTSMODEL_H
 #define TREMOTESF_TORRENTSMODEL_H
 
+#ifndef TREMOTESF_SAILFISHOS
+#include <array>
+#endif
 #include <memory>
 #include <vector>
 
@@ -101,16 +104,50 @@ namespace tremotesf
 
         Q_INVOKABLE QVariantList idsFromIndexes(const QModelIndexList& indexes) const;
 
+        // TorrentData::ChangedField flags of rows for which dataChanged() is being emitted
+        quint64 changingFields() const;
+        // TorrentData::ChangedField flags of row for which dataChanged() is being emitted
+        quint64 changingFields(int row) const;
+
+        // While updates are suspended model is empty, it is reset with current torrents when they are resumed
+        bool isUpdatesSuspended() const;
+        void setUpdatesSuspended(bool suspended);
+
 #ifdef TREMOTESF_SAILFISHOS
     protected:
         QHash<int, QByteArray> roleNames() const override;
 #endif
 
     private:
-        void update(const std::vector<int>& removed, const std::vector<int>& changed, int added);
+        void update(const std::vector<int>& removed, const std::vector<int>& changed, const std::vector<quint64>& changedFields, int added);
+        void emitDataChanged(int firstRow, int lastRow, quint64 fields);
+        void addTorrents(int count);
+        void clearTorrents();
+#ifndef TREMOTESF_SAILFISHOS
+        const QString& displayString(int row, int column) const;
+        void invalidateDisplayStrings(int row, quint64 fields);
+
+        // Formatted DisplayRole strings, valid is a bitmask of columns
+        struct DisplayStrings
+        {
+            std::array<QString, ColumnCount> strings;
+            quint32 valid = 0;
+        };
+        static_assert(ColumnCount <= 32, "DisplayStrings::valid must have a bit for each column");
+#endif
 
         std::vector<std::shared_ptr<libtremotesf::Torrent>> mTorrents;
         Rpc* mRpc;
+        quint64 mChangingFields;
+        const std::vector<int>* mChangingRows;
+        const std::vector<quint64>* mChangingRowsFields;
+        bool mUpdatesSuspended;
+#ifndef TREMOTESF_SAILFISHOS
+        mutable std::vector<DisplayStrings> mDisplayStrings;
+#endif
+    signals:
+        // Emitted after dataChanged() signals for all rows changed in one update
+        void dataChangedBatchFinished();
     };
 }
 
@@ -18,17 +18,289 @@
 
 #include "torrentsproxymodel.h"
 
+#include <algorithm>
+#include <functional>
+
+#include <QFuture>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+#include "modelutils.h"
 #include "torrentsmodel.h"
+#include "trpc.h"
 
 #include "libtremotesf/torrent.h"
-#include "libtremotesf/tracker.h"
 
 namespace tremotesf
 {
+    namespace
+    {
+        const quint64 filterFields = libtremotesf::TorrentData::NameChanged |
+                                     libtremotesf::TorrentData::StatusChanged |
+                                     libtremotesf::TorrentData::DownloadDirectoryChanged |
+                                     libtremotesf::TorrentData::TrackersChanged;
+
+        // Sorting all rows is faster than moving many of them one by one
+        size_t maxMovedRows(size_t rows)
+        {
+            return std::max(size_t(16), rows / 32);
+        }
+
+        // Smaller lists are sorted and filtered on GUI thread only
+        const size_t minParallelRows = 10000;
+
+        int parallelTasks(size_t rows)
+        {
+            if (rows < minParallelRows) {
+                return 1;
+            }
+            return std::max(1, QThread::idealThreadCount());
+        }
+
+        // Used only by runInParallel(), so that waiting GUI thread never queues behind unrelated tasks
+        QThreadPool* threadPool()
+        {
+            static QThreadPool pool;
+            return &pool;
+        }
+
+        // Calls function(task) for each task in [0, tasks) using dedicated thread pool,
+        // and waits until all of them are finished
+        template<typename Function>
+        void runInParallel(int tasks, const Function& function)
+        {
+            std::vector<QFuture<void>> futures;
+            futures.reserve(static_cast<size_t>(tasks));
+            for (int task = 1; task < tasks; ++task) {
+                futures.push_back(QtConcurrent::run(threadPool(), [&function, task]() {
+                    function(task);
+                }));
+            }
+            function(0);
+            for (QFuture<void>& future : futures) {
+                future.waitForFinished();
+            }
+        }
+
+        size_t taskBound(size_t size, int tasks, int task)
+        {
+            return size * static_cast<size_t>(task) / static_cast<size_t>(tasks);
+        }
+    }
+
     TorrentsProxyModel::TorrentsProxyModel(TorrentsModel* sourceModel, int sortRole, QObject* parent)
-        : BaseProxyModel(sourceModel, sortRole, parent),
-          mStatusFilter(All)
+        : QAbstractProxyModel(parent),
+          mStatusFilter(All),
+          mSortColumn(-1),
+          mSortOrder(Qt::AscendingOrder),
+          mSortRole(sortRole)
+    {
+        mCollator.setCaseSensitivity(Qt::CaseInsensitive);
+        mCollator.setNumericMode(true);
+        setSourceModel(sourceModel);
+    }
+
+    void TorrentsProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
+    {
+        beginResetModel();
+
+        if (this->sourceModel()) {
+            QObject::disconnect(this->sourceModel(), nullptr, this, nullptr);
+        }
+
+        QAbstractProxyModel::setSourceModel(sourceModel);
+
+        if (sourceModel) {
+            QObject::connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, [=](const QModelIndex&, int first, int last) {
+                const auto model = static_cast<const TorrentsModel*>(sourceModel);
+                std::vector<int> proxyRows;
+                for (int row = first; row <= last; ++row) {
+                    mNameSortKeys.erase(model->torrentAtRow(row));
+                    const int proxyRow = mProxyRows[static_cast<size_t>(row)];
+                    if (proxyRow != -1) {
+                        proxyRows.push_back(proxyRow);
+                    }
+                }
+                removeProxyRows(proxyRows);
+            });
+
+            QObject::connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, [=](const QModelIndex&, int first, int last) {
+                const int count = last - first + 1;
+                mProxyRows.erase(mProxyRows.begin() + first, mProxyRows.begin() + last + 1);
+                for (int& row : mSourceRows) {
+                    if (row > last) {
+                        row -= count;
+                    }
+                }
+            });
+
+            QObject::connect(sourceModel, &QAbstractItemModel::rowsInserted, this, [=](const QModelIndex&, int first, int last) {
+                const int count = last - first + 1;
+                for (int& row : mSourceRows) {
+                    if (row >= first) {
+                        row += count;
+                    }
+                }
+                mProxyRows.insert(mProxyRows.begin() + first, static_cast<size_t>(count), -1);
+
+                std::vector<int> accepted;
+                for (int row = first; row <= last; ++row) {
+                    if (filterAcceptsRow(row)) {
+                        accepted.push_back(row);
+                    }
+                }
+                insertSourceRows(accepted);
+            });
+
+            QObject::connect(sourceModel, &QAbstractItemModel::dataChanged, this, &TorrentsProxyModel::onSourceDataChanged);
+            QObject::connect(static_cast<TorrentsModel*>(sourceModel), &TorrentsModel::dataChangedBatchFinished, this, &TorrentsProxyModel::onSourceDataChangedBatchFinished);
+
+            QObject::connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, &TorrentsProxyModel::beginResetModel);
+            QObject::connect(sourceModel, &QAbstractItemModel::modelReset, this, [=]() {
+                resetRows();
+                endResetModel();
+            });
+        }
+
+        resetRows();
+
+        endResetModel();
+    }
+
+    QModelIndex TorrentsProxyModel::index(int row, int column, const QModelIndex& parent) const
+    {
+        if (parent.isValid() || row < 0 || row >= rowCount() || column < 0 || column >= columnCount()) {
+            return QModelIndex();
+        }
+        return createIndex(row, column);
+    }
+
+    QModelIndex TorrentsProxyModel::parent(const QModelIndex&) const
+    {
+        return QModelIndex();
+    }
+
+    int TorrentsProxyModel::rowCount(const QModelIndex& parent) const
+    {
+        if (parent.isValid()) {
+            return 0;
+        }
+        return static_cast<int>(mSourceRows.size());
+    }
+
+    int TorrentsProxyModel::columnCount(const QModelIndex& parent) const
+    {
+        if (parent.isValid() || !sourceModel()) {
+            return 0;
+        }
+        return sourceModel()->columnCount();
+    }
+
+    bool TorrentsProxyModel::hasChildren(const QModelIndex& parent) const
+    {
+        return !parent.isValid() && !mSourceRows.empty();
+    }
+
+    QVariant TorrentsProxyModel::headerData(int section, Qt::Orientation orientation, int role) const
+    {
+        if (!sourceModel()) {
+            return QVariant();
+        }
+        if (orientation == Qt::Vertical && section >= 0 && section < rowCount()) {
+            section = mSourceRows[static_cast<size_t>(section)];
+        }
+        return sourceModel()->headerData(section, orientation, role);
+    }
+
+    bool TorrentsProxyModel::removeRows(int row, int count, const QModelIndex& parent)
+    {
+        beginRemoveRows(parent, row, row + count - 1);
+        const auto first(mSourceRows.begin() + row);
+        const auto last(first + count);
+        for (auto i = first; i != last; ++i) {
+            mProxyRows[static_cast<size_t>(*i)] = -1;
+        }
+        mSourceRows.erase(first, last);
+        updateProxyRows(row, rowCount());
+        endRemoveRows();
+        return true;
+    }
+
+    QModelIndex TorrentsProxyModel::mapToSource(const QModelIndex& proxyIndex) const
+    {
+        if (!proxyIndex.isValid()) {
+            return QModelIndex();
+        }
+        return sourceModel()->index(mSourceRows[static_cast<size_t>(proxyIndex.row())], proxyIndex.column());
+    }
+
+    QModelIndex TorrentsProxyModel::mapFromSource(const QModelIndex& sourceIndex) const
+    {
+        const auto row = static_cast<size_t>(sourceIndex.row());
+        if (!sourceIndex.isValid() || row >= mProxyRows.size()) {
+            return QModelIndex();
+        }
+        const int proxyRow = mProxyRows[row];
+        if (proxyRow == -1) {
+            return QModelIndex();
+        }
+        return index(proxyRow, sourceIndex.column());
+    }
+
+    QModelIndex TorrentsProxyModel::sourceIndex(const QModelIndex& proxyIndex) const
+    {
+        return mapToSource(proxyIndex);
+    }
+
+    QModelIndex TorrentsProxyModel::sourceIndex(int proxyRow) const
+    {
+        return mapToSource(index(proxyRow, 0));
+    }
+
+    QModelIndexList TorrentsProxyModel::sourceIndexes(const QModelIndexList& proxyIndexes) const
+    {
+        QModelIndexList indexes;
+        indexes.reserve(proxyIndexes.size());
+        for (const QModelIndex& index : proxyIndexes) {
+            indexes.append(mapToSource(index));
+        }
+        return indexes;
+    }
+
+    int TorrentsProxyModel::sortColumn() const
     {
+        return mSortColumn;
+    }
+
+    Qt::SortOrder TorrentsProxyModel::sortOrder() const
+    {
+        return mSortOrder;
+    }
+
+    int TorrentsProxyModel::sortRole() const
+    {
+        return mSortRole;
+    }
+
+    void TorrentsProxyModel::setSortRole(int role)
+    {
+        if (role != mSortRole) {
+            mSortRole = role;
+            if (mSortColumn != -1) {
+                sortRowsWithLayoutChange();
+            }
+        }
+        emit sortRoleChanged();
+    }
+
+    void TorrentsProxyModel::sort(int column, Qt::SortOrder order)
+    {
+        if (column != mSortColumn || order != mSortOrder) {
+            mSortColumn = column;
+            mSortOrder = order;
+            sortRowsWithLayoutChange();
+        }
     }
 
     QString TorrentsProxyModel::searchString() const
@@ -39,8 +311,11 @@ namespace tremotesf
     void TorrentsProxyModel::setSearchString(const QString& string)
     {
         if (string != mSearchString) {
+            const libtremotesf::TorrentsNameIndex::Query query(string);
+            const bool narrowing = query.string.contains(mSearchQuery.string);
             mSearchString = string;
-            invalidateFilter();
+            mSearchQuery = query;
+            updateFilter(narrowing);
             emit searchStringChanged();
         }
     }
@@ -53,101 +328,556 @@ namespace tremotesf
     void TorrentsProxyModel::setStatusFilter(TorrentsProxyModel::StatusFilter filter)
     {
         if (filter != mStatusFilter) {
+            const bool narrowing = (mStatusFilter == All);
             mStatusFilter = filter;
-            invalidateFilter();
+            updateFilter(narrowing);
             emit statusFilterChanged();
         }
     }
 
     QString TorrentsProxyModel::tracker() const
     {
-        return mTracker;
+        return mTracker.toString();
     }
 
     void TorrentsProxyModel::setTracker(const QString& tracker)
     {
-        if (tracker != mTracker) {
-            mTracker = tracker;
-            invalidateFilter();
+        const libtremotesf::InternedString interned(tracker);
+        if (interned != mTracker) {
+            const bool narrowing = mTracker.isEmpty();
+            mTracker = interned;
+            updateFilter(narrowing);
             emit trackerChanged();
         }
     }
 
     QString TorrentsProxyModel::downloadDirectory() const
     {
-        return mDownloadDirectory;
+        return mDownloadDirectory.toString();
     }
 
     void TorrentsProxyModel::setDownloadDirectory(const QString& downloadDirectory)
     {
-        if (downloadDirectory != mDownloadDirectory) {
-            mDownloadDirectory = downloadDirectory;
-            invalidateFilter();
+        const libtremotesf::InternedString interned(downloadDirectory);
+        if (interned != mDownloadDirectory) {
+            const bool narrowing = mDownloadDirectory.isEmpty();
+            mDownloadDirectory = interned;
+            updateFilter(narrowing);
             emit downloadDirectoryChanged();
         }
     }
 
     bool TorrentsProxyModel::statusFilterAcceptsTorrent(const libtremotesf::Torrent* torrent, StatusFilter filter)
+    {
+        return statusFilterAcceptsStatus(torrent->status(), filter);
+    }
+
+    bool TorrentsProxyModel::statusFilterAcceptsStatus(libtremotesf::TorrentData::Status status, StatusFilter filter)
     {
         using libtremotesf::TorrentData;
         switch (filter) {
         case Active:
-            return (torrent->status() == TorrentData::Downloading || torrent->status() == TorrentData::Seeding);
+            return (status == TorrentData::Downloading || status == TorrentData::Seeding);
         case Downloading:
-            return (torrent->status() == TorrentData::Downloading ||
-                    torrent->status() == TorrentData::StalledDownloading ||
-                    torrent->status() == TorrentData::QueuedForDownloading);
+            return (status == TorrentData::Downloading ||
+                    status == TorrentData::StalledDownloading ||
+                    status == TorrentData::QueuedForDownloading);
         case Seeding:
-            return (torrent->status() == TorrentData::Seeding ||
-                    torrent->status() == TorrentData::StalledSeeding ||
-                    torrent->status() == TorrentData::QueuedForSeeding);
+            return (status == TorrentData::Seeding ||
+                    status == TorrentData::StalledSeeding ||
+                    status == TorrentData::QueuedForSeeding);
         case Paused:
-            return torrent->status() == TorrentData::Paused;
+            return status == TorrentData::Paused;
         case Checking:
-            return (torrent->status() == TorrentData::Checking ||
-                    torrent->status() == TorrentData::QueuedForChecking);
+            return (status == TorrentData::Checking ||
+                    status == TorrentData::QueuedForChecking);
         case Errored:
-            return torrent->status() == TorrentData::Errored;
+            return status == TorrentData::Errored;
         default:
             return true;
         }
     }
 
-    bool TorrentsProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex&) const
+    void TorrentsProxyModel::updateFilter(bool narrowing)
     {
-        bool accepts = true;
+        const std::vector<char> accepted(acceptedRows(narrowing));
+        std::vector<int> removed;
+        std::vector<int> inserted;
+        for (int row = 0, max = static_cast<int>(mProxyRows.size()); row < max; ++row) {
+            const int proxyRow = mProxyRows[static_cast<size_t>(row)];
+            if (proxyRow == -1) {
+                if (accepted[static_cast<size_t>(row)]) {
+                    inserted.push_back(row);
+                }
+            } else if (!accepted[static_cast<size_t>(row)]) {
+                removed.push_back(proxyRow);
+            }
+        }
+        removeProxyRows(removed);
+        insertSourceRows(inserted);
+    }
 
-        const libtremotesf::Torrent* torrent = static_cast<TorrentsModel*>(sourceModel())->torrentAtRow(sourceRow);
+    std::vector<char> TorrentsProxyModel::acceptedRows(bool onlyAccepted) const
+    {
+        const size_t size = mProxyRows.size();
+        std::vector<char> accepted(size);
+        const int tasks = parallelTasks(size);
+        runInParallel(tasks, [&](int task) {
+            for (size_t row = taskBound(size, tasks, task), max = taskBound(size, tasks, task + 1); row < max; ++row) {
+                if (!onlyAccepted || mProxyRows[row] != -1) {
+                    accepted[row] = filterAcceptsRow(static_cast<int>(row));
+                }
+            }
+        });
+        return accepted;
+    }
 
-        if (!mSearchString.isEmpty() &&
-            !torrent->name().contains(mSearchString, Qt::CaseInsensitive)) {
+    bool TorrentsProxyModel::filterAcceptsRow(int sourceRow) const
+    {
+        const auto model = static_cast<const TorrentsModel*>(sourceModel());
+        const libtremotesf::TorrentsColumns& columns = model->rpc()->torrentsColumns();
+        const auto row = static_cast<size_t>(sourceRow);
 
-            accepts = false;
+        if (!statusFilterAcceptsStatus(columns.status[row], mStatusFilter)) {
+            return false;
         }
 
-        if (!statusFilterAcceptsTorrent(torrent, mStatusFilter)) {
-            accepts = false;
+        if (!mDownloadDirectory.isEmpty()) {
+            if (columns.downloadDirectory[row] != mDownloadDirectory.id()) {
+                return false;
+            }
         }
 
-        if (!mTracker.isEmpty()) {
-            bool found = false;
-            for (const libtremotesf::Tracker& tracker : torrent->trackers()) {
-                if (tracker.site() == mTracker) {
-                    found = true;
-                    break;
+        if (!mTracker.isEmpty() && !model->rpc()->trackersGroups().hasTorrent(mTracker, sourceRow)) {
+            return false;
+        }
+
+        if (!mSearchString.isEmpty() && !columns.name.contains(row, mSearchQuery)) {
+            return false;
+        }
+
+        return true;
+    }
+
+    bool TorrentsProxyModel::lessThan(int leftSourceRow, int rightSourceRow) const
+    {
+        using libtremotesf::TorrentData;
+
+        const auto model = static_cast<const TorrentsModel*>(sourceModel());
+        const libtremotesf::TorrentsColumns& columns = model->rpc()->torrentsColumns();
+        const auto leftRow = static_cast<size_t>(leftSourceRow);
+        const auto rightRow = static_cast<size_t>(rightSourceRow);
+
+        const auto compare = [&](const auto& column) {
+            return column[leftRow] < column[rightRow];
+        };
+
+#ifdef TREMOTESF_SAILFISHOS
+        switch (mSortRole) {
+        case TorrentsModel::NameRole:
+            return nameSortKey(leftRow).compare(nameSortKey(rightRow)) < 0;
+        case TorrentsModel::StatusRole:
+            return compare(columns.status);
+        case TorrentsModel::TotalSizeRole:
+            return compare(columns.totalSize);
+        case TorrentsModel::PercentDoneRole:
+            return compare(columns.percentDone);
+        case TorrentsModel::EtaRole:
+            return compare(columns.eta);
+        case TorrentsModel::RatioRole:
+            return compare(columns.ratio);
+        case TorrentsModel::AddedDateRole:
+            return compare(columns.addedDate);
+        }
+#else
+        const auto progress = [&](size_t row) {
+            if (columns.status[row] == TorrentData::Checking) {
+                return columns.recheckProgress[row];
+            }
+            return columns.percentDone[row];
+        };
+
+        const auto downloadSpeedLimit = [&](int row) {
+            const libtremotesf::Torrent* torrent = model->torrentAtRow(row);
+            return torrent->isDownloadSpeedLimited() ? torrent->downloadSpeedLimit() : -1;
+        };
+
+        const auto uploadSpeedLimit = [&](int row) {
+            const libtremotesf::Torrent* torrent = model->torrentAtRow(row);
+            return torrent->isUploadSpeedLimited() ? torrent->uploadSpeedLimit() : -1;
+        };
+
+        if (mSortRole == TorrentsModel::SortRole) {
+            switch (mSortColumn) {
+            case TorrentsModel::NameColumn:
+                return nameSortKey(leftRow).compare(nameSortKey(rightRow)) < 0;
+            case TorrentsModel::SizeWhenDoneColumn:
+                return compare(columns.sizeWhenDone);
+            case TorrentsModel::TotalSizeColumn:
+                return compare(columns.totalSize);
+            case TorrentsModel::ProgressBarColumn:
+            case TorrentsModel::ProgressColumn:
+                return progress(leftRow) < progress(rightRow);
+            case TorrentsModel::StatusColumn:
+                return compare(columns.status);
+            case TorrentsModel::PriorityColumn:
+                return model->torrentAtRow(leftSourceRow)->bandwidthPriority() < model->torrentAtRow(rightSourceRow)->bandwidthPriority();
+            case TorrentsModel::QueuePositionColumn:
+                return compare(columns.queuePosition);
+            case TorrentsModel::SeedersColumn:
+                return compare(columns.seeders);
+            case TorrentsModel::LeechersColumn:
+                return compare(columns.leechers);
+            case TorrentsModel::DownloadSpeedColumn:
+                return compare(columns.downloadSpeed);
+            case TorrentsModel::UploadSpeedColumn:
+                return compare(columns.uploadSpeed);
+            case TorrentsModel::EtaColumn:
+                return compare(columns.eta);
+            case TorrentsModel::RatioColumn:
+                return compare(columns.ratio);
+            case TorrentsModel::AddedDateColumn:
+                return compare(columns.addedDate);
+            case TorrentsModel::DoneDateColumn:
+                return compare(columns.doneDate);
+            case TorrentsModel::DownloadSpeedLimitColumn:
+                return downloadSpeedLimit(leftSourceRow) < downloadSpeedLimit(rightSourceRow);
+            case TorrentsModel::UploadSpeedLimitColumn:
+                return uploadSpeedLimit(leftSourceRow) < uploadSpeedLimit(rightSourceRow);
+            case TorrentsModel::TotalDownloadedColumn:
+                return compare(columns.totalDownloaded);
+            case TorrentsModel::TotalUploadedColumn:
+                return compare(columns.totalUploaded);
+            case TorrentsModel::LeftUntilDoneColumn:
+                return compare(columns.leftUntilDone);
+            case TorrentsModel::DownloadDirectoryColumn:
+                return downloadDirectorySortKey(leftRow).compare(downloadDirectorySortKey(rightRow)) < 0;
+            case TorrentsModel::CompletedSizeColumn:
+                return compare(columns.completedSize);
+            case TorrentsModel::ActivityDateColumn:
+                return compare(columns.activityDate);
+            }
+        }
+#endif
+
+        return mCollator.compare(model->index(leftSourceRow, mSortColumn).data(mSortRole).toString(),
+                                 model->index(rightSourceRow, mSortColumn).data(mSortRole).toString()) < 0;
+    }
+
+    bool TorrentsProxyModel::sortsBefore(int sourceRow, int otherSourceRow) const
+    {
+        if (mSortColumn != -1) {
+            if (lessThan(sourceRow, otherSourceRow)) {
+                return (mSortOrder == Qt::AscendingOrder);
+            }
+            if (lessThan(otherSourceRow, sourceRow)) {
+                return (mSortOrder == Qt::DescendingOrder);
+            }
+        }
+        return sourceRow < otherSourceRow;
+    }
+
+    bool TorrentsProxyModel::isSortedByName() const
+    {
+#ifdef TREMOTESF_SAILFISHOS
+        return mSortRole == TorrentsModel::NameRole;
+#else
+        return mSortRole == TorrentsModel::SortRole && mSortColumn == TorrentsModel::NameColumn;
+#endif
+    }
+
+    const QCollatorSortKey& TorrentsProxyModel::nameSortKey(size_t row) const
+    {
+        const libtremotesf::Torrent* torrent = static_cast<const TorrentsModel*>(sourceModel())->torrentAtRow(static_cast<int>(row));
+        auto found(mNameSortKeys.find(torrent));
+        if (found == mNameSortKeys.end()) {
+            found = mNameSortKeys.emplace(torrent, mCollator.sortKey(torrent->name())).first;
+        }
+        return found->second;
+    }
+
+    const QCollatorSortKey& TorrentsProxyModel::downloadDirectorySortKey(size_t row) const
+    {
+        const auto model = static_cast<const TorrentsModel*>(sourceModel());
+        const libtremotesf::InternedString& directory = model->torrentAtRow(static_cast<int>(row))->data().downloadDirectory;
+        auto found(mDownloadDirectorySortKeys.find(directory));
+        if (found == mDownloadDirectorySortKeys.end()) {
+            found = mDownloadDirectorySortKeys.emplace(directory, mCollator.sortKey(directory.toString())).first;
+        }
+        return found->second;
+    }
+
+    void TorrentsProxyModel::onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles)
+    {
+        const auto model = static_cast<const TorrentsModel*>(sourceModel());
+
+        const bool sortChanged = (mSortColumn >= topLeft.column() &&
+                                  mSortColumn <= bottomRight.column() &&
+                                  (roles.isEmpty() || roles.contains(mSortRole)));
+
+        std::vector<int> removed;
+        std::vector<int> changed;
+        for (int row = topLeft.row(), max = bottomRight.row(); row <= max; ++row) {
+            const int proxyRow = mProxyRows[static_cast<size_t>(row)];
+            if (model->changingFields(row) & libtremotesf::TorrentData::NameChanged) {
+                mNameSortKeys.erase(model->torrentAtRow(row));
+            }
+            if (model->changingFields(row) & filterFields) {
+                const bool accepted = filterAcceptsRow(row);
+                if (proxyRow == -1) {
+                    if (accepted) {
+                        mInsertedSourceRows.push_back(row);
+                    }
+                    continue;
+                }
+                if (!accepted) {
+                    removed.push_back(proxyRow);
+                    continue;
                 }
+            } else if (proxyRow == -1) {
+                continue;
             }
-            if (!found) {
-                accepts = false;
+            changed.push_back(row);
+        }
+
+        removeProxyRows(removed);
+        if (sortChanged) {
+            mMovedSourceRows.insert(mMovedSourceRows.end(), changed.begin(), changed.end());
+        }
+
+        if (!changed.empty()) {
+            std::vector<int> proxyRows;
+            proxyRows.reserve(changed.size());
+            for (int row : changed) {
+                proxyRows.push_back(mProxyRows[static_cast<size_t>(row)]);
+            }
+            std::sort(proxyRows.begin(), proxyRows.end());
+
+            // Emit dataChanged() for each range of consecutive proxy rows
+            size_t first = 0;
+            for (size_t i = 1, max = proxyRows.size(); i <= max; ++i) {
+                if (i == max || proxyRows[i] != (proxyRows[i - 1] + 1)) {
+                    emit dataChanged(index(proxyRows[first], topLeft.column()), index(proxyRows[i - 1], bottomRight.column()), roles);
+                    first = i;
+                }
             }
         }
+    }
 
-        if (!mDownloadDirectory.isEmpty()) {
-            if (torrent->downloadDirectory() != mDownloadDirectory) {
-                accepts = false;
+    void TorrentsProxyModel::onSourceDataChangedBatchFinished()
+    {
+        // dataChanged() may be emitted for the same rows several times with different columns
+        const auto takeUnique = [](std::vector<int>& rows) {
+            std::vector<int> unique;
+            unique.swap(rows);
+            std::sort(unique.begin(), unique.end());
+            unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+            return unique;
+        };
+
+        moveSourceRows(takeUnique(mMovedSourceRows));
+        std::vector<int> inserted(takeUnique(mInsertedSourceRows));
+        insertSourceRows(inserted);
+    }
+
+    void TorrentsProxyModel::resetRows()
+    {
+        mMovedSourceRows.clear();
+        mInsertedSourceRows.clear();
+        mNameSortKeys.clear();
+        mSourceRows.clear();
+        mProxyRows.assign(sourceModel() ? static_cast<size_t>(sourceModel()->rowCount()) : 0, -1);
+        const std::vector<char> accepted(acceptedRows(false));
+        for (int row = 0, max = static_cast<int>(accepted.size()); row < max; ++row) {
+            if (accepted[static_cast<size_t>(row)]) {
+                mSourceRows.push_back(row);
             }
         }
+        sortRows();
+    }
 
-        return accepts;
+    void TorrentsProxyModel::sortRows()
+    {
+        const auto before = [=](int first, int second) {
+            return sortsBefore(first, second);
+        };
+
+        mDownloadDirectorySortKeys.clear();
+
+        const size_t size = mSourceRows.size();
+#ifdef TREMOTESF_SAILFISHOS
+        const int tasks = parallelTasks(size);
+#else
+        // Other roles are compared using QVariant and QCollator which can't be used from multiple threads
+        const int tasks = (mSortRole == TorrentsModel::SortRole) ? parallelTasks(size) : 1;
+#endif
+        if (tasks == 1) {
+            std::sort(mSourceRows.begin(), mSourceRows.end(), before);
+        } else {
+#ifndef TREMOTESF_SAILFISHOS
+            // Fill caches before they are accessed from multiple threads
+            if (mSortColumn == TorrentsModel::DownloadDirectoryColumn) {
+                for (int row : mSourceRows) {
+                    downloadDirectorySortKey(static_cast<size_t>(row));
+                }
+            }
+#endif
+            if (isSortedByName()) {
+                for (int row : mSourceRows) {
+                    nameSortKey(static_cast<size_t>(row));
+                }
+            }
+            const auto begin(mSourceRows.begin());
+
+            // Sort parts in parallel
+            runInParallel(tasks, [&](int task) {
+                std::sort(begin + static_cast<std::ptrdiff_t>(taskBound(size, tasks, task)),
+                          begin + static_cast<std::ptrdiff_t>(taskBound(size, tasks, task + 1)),
+                          before);
+            });
+
+            // Merge pairs of adjacent sorted parts in parallel until one part is left
+            for (int width = 1; width < tasks; width *= 2) {
+                const int merges = (tasks + 2 * width - 1) / (2 * width);
+                runInParallel(merges, [&](int merge) {
+                    const int first = merge * 2 * width;
+                    const int middle = std::min(first + width, tasks);
+                    const int last = std::min(first + 2 * width, tasks);
+                    std::inplace_merge(begin + static_cast<std::ptrdiff_t>(taskBound(size, tasks, first)),
+                                       begin + static_cast<std::ptrdiff_t>(taskBound(size, tasks, middle)),
+                                       begin + static_cast<std::ptrdiff_t>(taskBound(size, tasks, last)),
+                                       before);
+                });
+            }
+        }
+
+        updateProxyRows(0, rowCount());
+    }
+
+    void TorrentsProxyModel::sortRowsWithLayoutChange()
+    {
+        emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+        const QModelIndexList oldIndexes(persistentIndexList());
+        std::vector<int> sourceRows;
+        sourceRows.reserve(static_cast<size_t>(oldIndexes.size()));
+        for (const QModelIndex& index : oldIndexes) {
+            sourceRows.push_back(mSourceRows[static_cast<size_t>(index.row())]);
+        }
+
+        sortRows();
+
+        QModelIndexList newIndexes;
+        newIndexes.reserve(oldIndexes.size());
+        for (int i = 0, max = oldIndexes.size(); i < max; ++i) {
+            newIndexes.push_back(index(mProxyRows[static_cast<size_t>(sourceRows[static_cast<size_t>(i)])], oldIndexes[i].column()));
+        }
+        changePersistentIndexList(oldIndexes, newIndexes);
+
+        emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    }
+
+    void TorrentsProxyModel::insertSourceRows(std::vector<int>& sourceRows)
+    {
+        if (sourceRows.empty()) {
+            return;
+        }
+
+        const auto before = [=](int first, int second) {
+            return sortsBefore(first, second);
+        };
+
+        std::sort(sourceRows.begin(), sourceRows.end(), before);
+
+        std::vector<int> positions;
+        positions.reserve(sourceRows.size());
+        for (int row : sourceRows) {
+            positions.push_back(static_cast<int>(std::upper_bound(mSourceRows.begin(), mSourceRows.end(), row, before) - mSourceRows.begin()));
+        }
+
+        // Insert rows with the same position at once, starting from the end so that positions stay valid
+        size_t last = sourceRows.size();
+        while (last > 0) {
+            size_t first = last - 1;
+            while (first > 0 && positions[first - 1] == positions[first]) {
+                --first;
+            }
+            const int position = positions[first];
+            beginInsertRows(QModelIndex(), position, position + static_cast<int>(last - first) - 1);
+            mSourceRows.insert(mSourceRows.begin() + position, sourceRows.begin() + static_cast<std::ptrdiff_t>(first), sourceRows.begin() + static_cast<std::ptrdiff_t>(last));
+            updateProxyRows(position, rowCount());
+            endInsertRows();
+            last = first;
+        }
+    }
+
+    void TorrentsProxyModel::removeProxyRows(std::vector<int>& proxyRows)
+    {
+        if (proxyRows.empty()) {
+            return;
+        }
+        std::sort(proxyRows.begin(), proxyRows.end(), std::greater<int>());
+        ModelBatchRemover remover(this);
+        for (int row : proxyRows) {
+            remover.remove(row);
+        }
+        remover.remove();
+    }
+
+    void TorrentsProxyModel::moveSourceRows(const std::vector<int>& sourceRows)
+    {
+        if (sourceRows.empty() || mSortColumn == -1) {
+            return;
+        }
+
+        if (sourceRows.size() > maxMovedRows(mSourceRows.size())) {
+            sortRowsWithLayoutChange();
+            return;
+        }
+
+        // Rows that are not pending are sorted, pending rows are skipped when searching for new position
+        std::vector<bool> pending(mProxyRows.size());
+        for (int row : sourceRows) {
+            pending[static_cast<size_t>(row)] = true;
+        }
+
+        for (int row : sourceRows) {
+            int low = 0;
+            int high = rowCount();
+            while (low < high) {
+                const int middle = low + (high - low) / 2;
+                int probe = middle;
+                while (probe < high && pending[static_cast<size_t>(mSourceRows[static_cast<size_t>(probe)])]) {
+                    ++probe;
+                }
+                if (probe == high || sortsBefore(row, mSourceRows[static_cast<size_t>(probe)])) {
+                    high = middle;
+                } else {
+                    low = probe + 1;
+                }
+            }
+            pending[static_cast<size_t>(row)] = false;
+
+            const int proxyRow = mProxyRows[static_cast<size_t>(row)];
+            if (low != proxyRow && low != (proxyRow + 1)) {
+                beginMoveRows(QModelIndex(), proxyRow, proxyRow, QModelIndex(), low);
+                const auto begin(mSourceRows.begin());
+                if (low > proxyRow) {
+                    std::rotate(begin + proxyRow, begin + proxyRow + 1, begin + low);
+                    updateProxyRows(proxyRow, low);
+                } else {
+                    std::rotate(begin + low, begin + proxyRow, begin + proxyRow + 1);
+                    updateProxyRows(low, proxyRow + 1);
+                }
+                endMoveRows();
+            }
+        }
+    }
+
+    void TorrentsProxyModel::updateProxyRows(int first, int last)
+    {
+        for (int proxyRow = first; proxyRow < last; ++proxyRow) {
+            mProxyRows[static_cast<size_t>(mSourceRows[static_cast<size_t>(proxyRow)])] = proxyRow;
+        }
     }
 }
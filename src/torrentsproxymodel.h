@@ -19,20 +19,27 @@
 #ifndef TREMOTESF_TORRENTSPROXYMODEL_H
 #define TREMOTESF_TORRENTSPROXYMODEL_H
 
-#include "baseproxymodel.h"
+#include <unordered_map>
+#include <vector>
 
-namespace libtremotesf
-{
-    class Torrent;
-}
+#include <QAbstractProxyModel>
+#include <QCollator>
+#include <QModelIndexList>
+
+#include "libtremotesf/torrent.h"
+#include "libtremotesf/torrentsnameindex.h"
 
 namespace tremotesf
 {
     class TorrentsModel;
 
-    class TorrentsProxyModel : public BaseProxyModel
+    // Unlike QSortFilterProxyModel, changed rows are moved to their new positions
+    // one by one instead of re-sorting with layoutChanged()
+    class TorrentsProxyModel : public QAbstractProxyModel
     {
         Q_OBJECT
+        Q_PROPERTY(Qt::SortOrder sortOrder READ sortOrder)
+        Q_PROPERTY(int sortRole READ sortRole WRITE setSortRole NOTIFY sortRoleChanged)
         Q_PROPERTY(QString searchString READ searchString WRITE setSearchString NOTIFY searchStringChanged)
         Q_PROPERTY(StatusFilter statusFilter READ statusFilter WRITE setStatusFilter NOTIFY statusFilterChanged)
         Q_PROPERTY(QString tracker READ tracker WRITE setTracker NOTIFY trackerChanged)
@@ -53,6 +60,29 @@ namespace tremotesf
 
         explicit TorrentsProxyModel(TorrentsModel* sourceModel = nullptr, int sortRole = Qt::DisplayRole, QObject* parent = nullptr);
 
+        void setSourceModel(QAbstractItemModel* sourceModel) override;
+
+        QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+        QModelIndex parent(const QModelIndex&) const override;
+        int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+        int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+        bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+        QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+        bool removeRows(int row, int count, const QModelIndex& parent = QModelIndex()) override;
+
+        QModelIndex mapToSource(const QModelIndex& proxyIndex) const override;
+        QModelIndex mapFromSource(const QModelIndex& sourceIndex) const override;
+
+        Q_INVOKABLE QModelIndex sourceIndex(const QModelIndex& proxyIndex) const;
+        Q_INVOKABLE QModelIndex sourceIndex(int proxyRow) const;
+        Q_INVOKABLE QModelIndexList sourceIndexes(const QModelIndexList& proxyIndexes) const;
+
+        int sortColumn() const;
+        Qt::SortOrder sortOrder() const;
+        int sortRole() const;
+        void setSortRole(int role);
+        Q_INVOKABLE void sort(int column = 0, Qt::SortOrder order = Qt::AscendingOrder) override;
+
         QString searchString() const;
         void setSearchString(const QString& string);
 
@@ -66,20 +96,65 @@ namespace tremotesf
         void setDownloadDirectory(const QString& downloadDirectory);
 
         static bool statusFilterAcceptsTorrent(const libtremotesf::Torrent* torrent, StatusFilter filter);
-
-    protected:
-        bool filterAcceptsRow(int sourceRow, const QModelIndex&) const override;
+        static bool statusFilterAcceptsStatus(libtremotesf::TorrentData::Status status, StatusFilter filter);
 
     private:
+        void onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
+        void onSourceDataChangedBatchFinished();
+
+        // If narrowing is true, rows that were not accepted before are not checked again
+        void updateFilter(bool narrowing);
+        // Returns whether each source row is accepted, if onlyAccepted is true rows that are filtered out are not checked
+        std::vector<char> acceptedRows(bool onlyAccepted) const;
+        bool filterAcceptsRow(int sourceRow) const;
+
+        bool lessThan(int leftSourceRow, int rightSourceRow) const;
+        // Takes sort order into account, rows with equal keys keep source order
+        bool sortsBefore(int sourceRow, int otherSourceRow) const;
+        bool isSortedByName() const;
+        const QCollatorSortKey& nameSortKey(size_t row) const;
+        const QCollatorSortKey& downloadDirectorySortKey(size_t row) const;
+
+        void resetRows();
+        void sortRows();
+        void sortRowsWithLayoutChange();
+        void insertSourceRows(std::vector<int>& sourceRows);
+        void removeProxyRows(std::vector<int>& proxyRows);
+        void moveSourceRows(const std::vector<int>& sourceRows);
+        void updateProxyRows(int first, int last);
+
         QString mSearchString;
+        libtremotesf::TorrentsNameIndex::Query mSearchQuery;
         StatusFilter mStatusFilter;
-        QString mTracker;
-        QString mDownloadDirectory;
+        libtremotesf::InternedString mTracker;
+        libtremotesf::InternedString mDownloadDirectory;
+
+        int mSortColumn;
+        Qt::SortOrder mSortOrder;
+        int mSortRole;
+        QCollator mCollator;
+
+        // Source rows in proxy order
+        std::vector<int> mSourceRows;
+        // Proxy rows indexed by source rows, -1 if source row is filtered out
+        std::vector<int> mProxyRows;
+
+        // Source rows that need to be moved or inserted after current batch of dataChanged() signals.
+        // Rows of later batches are already changed when first one is received, so they can't be
+        // placed before all of them are known
+        std::vector<int> mMovedSourceRows;
+        std::vector<int> mInsertedSourceRows;
+
+        // Computed on first sort by name, entries are removed when torrent is removed or renamed
+        mutable std::unordered_map<const libtremotesf::Torrent*, QCollatorSortKey> mNameSortKeys;
+        // Cleared on each full sort so that it doesn't keep removed directories alive
+        mutable std::unordered_map<libtremotesf::InternedString, QCollatorSortKey> mDownloadDirectorySortKeys;
     signals:
         void searchStringChanged();
         void statusFilterChanged();
         void trackerChanged();
         void downloadDirectoryChanged();
+        void sortRoleChanged();
     };
 }
 
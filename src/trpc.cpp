@@ -21,9 +21,12 @@
 #include <QCoreApplication>
 #include <QFileInfo>
 #include <QStringBuilder>
+#include <QTimer>
 
 #include "libtremotesf/serversettings.h"
 #include "libtremotesf/torrent.h"
+#include "libtremotesf/tracker.h"
+#include "pathexistencecache.h"
 #include "servers.h"
 #include "settings.h"
 
@@ -31,39 +34,63 @@ namespace tremotesf
 {
     Rpc::Rpc(QObject* parent)
         : libtremotesf::Rpc(true, parent),
-          mIncompleteDirectoryMounted(false)
+          mTrackersGroups([](const libtremotesf::Torrent* torrent, std::vector<libtremotesf::InternedString>& groups) {
+              for (const libtremotesf::Tracker& tracker : torrent->trackers()) {
+                  groups.push_back(tracker.internedSite());
+              }
+          }, libtremotesf::TorrentData::TrackersChanged),
+          mPathExistenceCache(new PathExistenceCache(this)),
+          mIncompleteDirectoryMounted(false),
+          mTorrentsSnapshotTimer(new QTimer(this))
     {
+        // Connect first so that models see updated groups
+        QObject::connect(this, &Rpc::torrentsUpdated, this, [=](const std::vector<int>& removed, const std::vector<int>& changed, const std::vector<quint64>& changedFields, int added) {
+            mTrackersGroups.update(this, removed, changed, changedFields, added);
+        });
+
         QObject::connect(this, &Rpc::statusChanged, this, &Rpc::statusStringChanged);
         QObject::connect(this, &Rpc::errorChanged, this, &Rpc::statusStringChanged);
 
+        // Show torrents from last session while connecting
+        QObject::connect(this, &Rpc::statusChanged, this, [=]() {
+            if (status() == Connecting) {
+                mServerName = Servers::instance()->currentServerName();
+                Servers::instance()->loadTorrentsSnapshot(mServerName, this);
+            }
+        });
+
+        QObject::connect(Servers::instance(), &Servers::serversRenamed, this, [=](const QHash<QString, QString>& names) {
+            mServerName = names.value(mServerName, mServerName);
+        });
+
+        mTorrentsSnapshotTimer->setInterval(5 * 60 * 1000); // 5 minutes
+        QObject::connect(mTorrentsSnapshotTimer, &QTimer::timeout, this, [=]() {
+            Servers::instance()->saveTorrentsSnapshot(mServerName, this);
+        });
+
         QObject::connect(this, &Rpc::connectedChanged, this, [=]() {
             if (isConnected()) {
                 const bool notifyOnAdded = Settings::instance()->notificationsOnAddedTorrentsSinceLastConnection();
                 const bool notifyOnFinished = Settings::instance()->notificationsOnFinishedTorrentsSinceLastConnection();
                 if (notifyOnAdded || notifyOnFinished) {
-                    const LastTorrents lastTorrents(Servers::instance()->currentServerLastTorrents());
-                    if (lastTorrents.saved) {
+                    const LastTorrents lastTorrents(Servers::instance()->lastTorrents(mServerName));
+                    if (lastTorrents.isSaved()) {
                         QStringList addedHashes;
                         QStringList addedNames;
                         QStringList finishedHashes;
                         QStringList finishedNames;
                         for (const auto& torrent : torrents()) {
-                            const QString hashString(torrent->hashString());
-                            const auto found = std::find_if(lastTorrents.torrents.cbegin(),
-                                                            lastTorrents.torrents.cend(),
-                                                            [&hashString](const LastTorrents::Torrent& torrent) {
-                                return torrent.hashString == hashString;
-                            });
-                            if (found == lastTorrents.torrents.cend()) {
+                            bool wasFinished = false;
+                            if (lastTorrents.find(torrent->hash(), wasFinished)) {
+                                if (notifyOnFinished && !wasFinished && torrent->isFinished()) {
+                                    finishedHashes.push_back(torrent->hashString());
+                                    finishedNames.push_back(torrent->name());
+                                }
+                            } else {
                                 if (notifyOnAdded) {
                                     addedHashes.push_back(torrent->hashString());
                                     addedNames.push_back(torrent->name());
                                 }
-                            } else {
-                                if (notifyOnFinished && !found->finished && torrent->isFinished()) {
-                                    finishedHashes.push_back(torrent->hashString());
-                                    finishedNames.push_back(torrent->name());
-                                }
                             }
                         }
 
@@ -75,8 +102,11 @@ namespace tremotesf
                         }
                     }
                 }
+                mTorrentsSnapshotTimer->start();
             } else {
                 mIncompleteDirectoryMounted = false;
+                mPathExistenceCache->clear();
+                mTorrentsSnapshotTimer->stop();
             }
         });
 
@@ -93,7 +123,8 @@ namespace tremotesf
         });
 
         QObject::connect(this, &Rpc::aboutToDisconnect, this, [=]() {
-            Servers::instance()->saveCurrentServerLastTorrents(this);
+            Servers::instance()->saveLastTorrents(mServerName, this);
+            Servers::instance()->saveTorrentsSnapshot(mServerName, this);
         });
 
         QObject::connect(this, &Rpc::torrentsUpdated, this, [=]() {
@@ -132,6 +163,11 @@ namespace tremotesf
         return QString();
     }
 
+    const TorrentsGroups& Rpc::trackersGroups() const
+    {
+        return mTrackersGroups;
+    }
+
     bool Rpc::isIncompleteDirectoryMounted() const
     {
         return mIncompleteDirectoryMounted;
@@ -142,17 +178,21 @@ namespace tremotesf
         return isLocal() ||
                 (Servers::instance()->currentServerHasMountedDirectories() &&
                  (serverSettings()->isIncompleteDirectoryEnabled() && torrent->leftUntilDone() > 0 ? mIncompleteDirectoryMounted : true) &&
-                 !Servers::instance()->fromRemoteToLocalDirectory(torrent->downloadDirectory()).isEmpty());
+                 !Servers::instance()->fromRemoteToLocalDirectory(torrent->data().downloadDirectory).isEmpty());
     }
 
-    QString Rpc::localTorrentDownloadDirectoryPath(libtremotesf::Torrent* torrent) const
+    QString Rpc::localTorrentDownloadDirectoryPath(libtremotesf::Torrent* torrent, bool useCache) const
     {
+        const auto exists = [&](const QString& path) {
+            return useCache ? mPathExistenceCache->exists(path) : QFileInfo::exists(path);
+        };
+
         const bool incompleteDirectoryEnabled = serverSettings()->isIncompleteDirectoryEnabled();
         QString filePath;
         if (isLocal()) {
             if (incompleteDirectoryEnabled &&
                     torrent->leftUntilDone() > 0 &&
-                    QFileInfo::exists(serverSettings()->incompleteDirectory() % '/' % torrentRootFileName(torrent))) {
+                    exists(serverSettings()->incompleteDirectory() % '/' % torrentRootFileName(torrent))) {
                 filePath = serverSettings()->incompleteDirectory();
             } else {
                 filePath = torrent->downloadDirectory();
@@ -162,25 +202,30 @@ namespace tremotesf
                 if (incompleteDirectoryEnabled &&
                         torrent->leftUntilDone() > 0 &&
                         mIncompleteDirectoryMounted &&
-                        QFileInfo::exists(mMountedIncompleteDirectory % '/' % torrentRootFileName(torrent))) {
+                        exists(mMountedIncompleteDirectory % '/' % torrentRootFileName(torrent))) {
                     filePath = mMountedIncompleteDirectory;
                 } else {
-                    filePath = Servers::instance()->fromRemoteToLocalDirectory(torrent->downloadDirectory());
+                    filePath = Servers::instance()->fromRemoteToLocalDirectory(torrent->data().downloadDirectory);
                 }
             }
         }
         return filePath;
     }
 
-    QString Rpc::localTorrentFilesPath(libtremotesf::Torrent* torrent) const
+    QString Rpc::localTorrentFilesPath(libtremotesf::Torrent* torrent, bool useCache) const
     {
-        const QString downloadDirectoryPath(localTorrentDownloadDirectoryPath(torrent));
+        const QString downloadDirectoryPath(localTorrentDownloadDirectoryPath(torrent, useCache));
         if (downloadDirectoryPath.isEmpty()) {
             return QString();
         }
         return downloadDirectoryPath % '/' % torrentRootFileName(torrent);
     }
 
+    PathExistenceCache* Rpc::pathExistenceCache() const
+    {
+        return mPathExistenceCache;
+    }
+
     QString Rpc::torrentRootFileName(const libtremotesf::Torrent* torrent) const
     {
         if (torrent->isSingleFile() && torrent->leftUntilDone() > 0 && serverSettings()->renameIncompleteFiles()) {
@@ -20,9 +20,14 @@
 #define TREMOTESF_RPC_H
 
 #include "libtremotesf/rpc.h"
+#include "torrentsgroups.h"
+
+class QTimer;
 
 namespace tremotesf
 {
+    class PathExistenceCache;
+
     class Rpc : public libtremotesf::Rpc
     {
         Q_OBJECT
@@ -31,16 +36,28 @@ namespace tremotesf
         explicit Rpc(QObject* parent = nullptr);
         QString statusString() const;
 
+        // Torrents grouped by tracker sites, updated before other torrentsUpdated() receivers
+        const TorrentsGroups& trackersGroups() const;
+
         bool isIncompleteDirectoryMounted() const;
         Q_INVOKABLE bool isTorrentLocalMounted(libtremotesf::Torrent* torrent) const;
-        Q_INVOKABLE QString localTorrentFilesPath(libtremotesf::Torrent* torrent) const;
-        Q_INVOKABLE QString localTorrentDownloadDirectoryPath(libtremotesf::Torrent* torrent) const;
+        // If useCache is true, existence of files is taken from pathExistenceCache() instead of checking it
+        Q_INVOKABLE QString localTorrentFilesPath(libtremotesf::Torrent* torrent, bool useCache = false) const;
+        Q_INVOKABLE QString localTorrentDownloadDirectoryPath(libtremotesf::Torrent* torrent, bool useCache = false) const;
+
+        PathExistenceCache* pathExistenceCache() const;
     private:
         QString torrentRootFileName(const libtremotesf::Torrent* torrent) const;
 
+        TorrentsGroups mTrackersGroups;
+        PathExistenceCache* mPathExistenceCache;
+
         bool mIncompleteDirectoryMounted;
         QString mMountedIncompleteDirectory;
 
+        QString mServerName;
+        QTimer* mTorrentsSnapshotTimer;
+
     signals:
         void statusStringChanged();
 
@@ -89,6 +89,7 @@ namespace tremotesf
 #include <QDesktopServices>
 #include <QDir>
 #include <QFileInfo>
+#include <QIcon>
 #include <QMessageBox>
 #include <QUrl>
 #if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
@@ -146,19 +147,56 @@ namespace tremotesf
                 ByteUnitStrings{[]() { return qApp->translate("tremotesf", "%L1 YiB"); }, []() { return qApp->translate("tremotesf", "%L1 YiB/s"); }},
         };
 
+        // Translated strings and locale used for formatting, created on first use
+        // (translators are installed at startup and are not changed later)
+        struct FormatStrings
+        {
+            FormatStrings()
+                : speedLimit(qApp->translate("tremotesf", "%L1 KiB/s")),
+                  progress(qApp->translate("tremotesf", "%L1%")),
+                  etaDays(qApp->translate("tremotesf", "%L1 d %L2 h")),
+                  etaHours(qApp->translate("tremotesf", "%L1 h %L2 m")),
+                  etaMinutes(qApp->translate("tremotesf", "%L1 m %L2 s")),
+                  etaSeconds(qApp->translate("tremotesf", "%L1 s"))
+            {
+                for (size_t unit = 0; unit < NumberOfByteUnits; ++unit) {
+                    for (size_t type = 0; type < bytes[unit].size(); ++type) {
+                        bytes[unit][type] = byteUnits[unit].strings[type]();
+                    }
+                }
+            }
+
+            QLocale locale;
+            std::array<std::array<QString, 2>, NumberOfByteUnits> bytes;
+            QString speedLimit;
+            QString progress;
+            QString etaDays;
+            QString etaHours;
+            QString etaMinutes;
+            QString etaSeconds;
+        };
+
+        const FormatStrings& formatStrings()
+        {
+            static const FormatStrings strings;
+            return strings;
+        }
+
         QString formatBytes(long long bytes, ByteUnitStrings::Type stringType)
         {
+            const FormatStrings& strings = formatStrings();
+
+            if (bytes < 1024) {
+                return strings.bytes[Byte][stringType].arg(strings.locale.toString(bytes));
+            }
+
             int unit = 0;
             auto bytes_d = static_cast<double>(bytes);
-            while (bytes_d >= 1024.0 && unit <= NumberOfByteUnits) {
+            while (bytes_d >= 1024.0 && unit < (NumberOfByteUnits - 1)) {
                 bytes_d /= 1024.0;
                 ++unit;
             }
-
-            if (unit == Byte) {
-                return byteUnits[Byte].strings[stringType]().arg(bytes_d);
-            }
-            return byteUnits[unit].strings[stringType]().arg(bytes_d, 0, 'f', 1);
+            return strings.bytes[static_cast<size_t>(unit)][stringType].arg(strings.locale.toString(bytes_d, 'f', 1));
         }
     }
 
@@ -174,15 +212,17 @@ namespace tremotesf
 
     QString Utils::formatSpeedLimit(int limit)
     {
-        return qApp->translate("tremotesf", "%L1 KiB/s").arg(limit);
+        const FormatStrings& strings = formatStrings();
+        return strings.speedLimit.arg(strings.locale.toString(limit));
     }
 
     QString Utils::formatProgress(double progress)
     {
+        const FormatStrings& strings = formatStrings();
         if (qFuzzyCompare(progress, 1.0)) {
-            return qApp->translate("tremotesf", "%L1%").arg(100);
+            return strings.progress.arg(strings.locale.toString(100));
         } else {
-            return qApp->translate("tremotesf", "%L1%").arg(std::trunc(progress * 1000.0) / 10.0, 0, 'f', 1);
+            return strings.progress.arg(strings.locale.toString(std::trunc(progress * 1000.0) / 10.0, 'f', 1));
         }
     }
 
@@ -198,7 +238,7 @@ namespace tremotesf
         } else if (ratio >= 10) {
             precision = 1;
         }
-        return QLocale().toString(ratio, 'f', precision);
+        return formatStrings().locale.toString(ratio, 'f', precision);
     }
 
     QString Utils::formatRatio(long long downloaded, long long uploaded)
@@ -222,19 +262,22 @@ namespace tremotesf
         const int minutes = seconds / 60;
         seconds %= 60;
 
+        const FormatStrings& strings = formatStrings();
+        const QLocale& locale = strings.locale;
+
         if (days > 0) {
-            return qApp->translate("tremotesf", "%L1 d %L2 h").arg(days).arg(hours);
+            return strings.etaDays.arg(locale.toString(days), locale.toString(hours));
         }
 
         if (hours > 0) {
-            return qApp->translate("tremotesf", "%L1 h %L2 m").arg(hours).arg(minutes);
+            return strings.etaHours.arg(locale.toString(hours), locale.toString(minutes));
         }
 
         if (minutes > 0) {
-            return qApp->translate("tremotesf", "%L1 m %L2 s").arg(minutes).arg(seconds);
+            return strings.etaMinutes.arg(locale.toString(minutes), locale.toString(seconds));
         }
 
-        return qApp->translate("tremotesf", "%L1 s").arg(seconds);
+        return strings.etaSeconds.arg(locale.toString(seconds));
     }
 
     QString Utils::license()
@@ -383,6 +426,19 @@ namespace tremotesf
         return QString();
     }
 
+    const QIcon& Utils::statusIcon(StatusIcon icon)
+    {
+        // Intentionally leaked, so that icons' pixmaps are not destroyed after QApplication
+        static const auto icons = []() {
+            auto icons = new std::array<QIcon, NumberOfStatusIcons>();
+            for (int i = 0; i < NumberOfStatusIcons; ++i) {
+                (*icons)[static_cast<size_t>(i)] = QIcon(statusIconPath(static_cast<StatusIcon>(i)));
+            }
+            return icons;
+        }();
+        return (*icons)[static_cast<size_t>(icon)];
+    }
+
     void Utils::openFile(const QString& filePath, QWidget* parent)
     {
         const QString nativePath(QDir::toNativeSeparators(filePath));
@@ -22,6 +22,7 @@
 #include <QObject>
 
 #ifndef TREMOTESF_SAILFISHOS
+class QIcon;
 class QWidget;
 #endif
 
@@ -64,9 +65,12 @@ namespace tremotesf
             QueuedIcon,
             SeedingIcon,
             StalledDownloadingIcon,
-            StalledSeedingIcon
+            StalledSeedingIcon,
+            NumberOfStatusIcons
         };
         static QString statusIconPath(StatusIcon icon);
+        // Icons are loaded once and shared, QIcon picks pixmap for device pixel ratio when painting
+        static const QIcon& statusIcon(StatusIcon icon);
 
         static void openFile(const QString& filePath, QWidget* parent = nullptr);
         static void selectFilesInFileManager(const QStringList& files, QWidget* parent = nullptr);